@@ -0,0 +1,168 @@
+#!/bin/python3
+import argparse
+import struct
+import sys
+
+# decodes binary telemetry records (see 'src/telemetry.hpp') from the serial
+# port or a file and prints them as text or csv, or plots frame timings
+#
+# usage: telemetry-decode.py [--csv | --plot] [--baud <rate>] [source]
+#        source is a serial device such as '/dev/ttyUSB0', a file or stdin
+#
+# note. text output by 'printf' between records is skipped
+
+SYNC = 0xA5
+
+# type: (name, struct format, field names)
+RECORDS = {
+    1: (
+        "frame",
+        "<IIIHHHHHH",
+        [
+            "ms",
+            "frame_us",
+            "engine_us",
+            "objects",
+            "sprites",
+            "dma_writes",
+            "dma_busy",
+            "objects_freed",
+            "sprites_freed",
+        ],
+    ),
+    2: (
+        "status",
+        "<IIIHH",
+        ["ms", "free_heap_B", "dropped", "fps", "ldr"],
+    ),
+    3: (
+        "stores",
+        "<IIIIIHH",
+        [
+            "ms",
+            "objects_allocations",
+            "objects_failed",
+            "sprites_allocations",
+            "sprites_failed",
+            "objects_peak",
+            "sprites_peak",
+        ],
+    ),
+}
+
+
+def add_churn(records):
+    # adds allocations per second since previous record to 'stores' records
+    prv = None
+    for name, fields in records:
+        if name == "stores":
+            for store in ("objects", "sprites"):
+                churn = 0
+                if prv and fields["ms"] > prv["ms"]:
+                    allocs = fields[store + "_allocations"] - prv[store + "_allocations"]
+                    churn = allocs * 1000 // (fields["ms"] - prv["ms"])
+                fields[store + "_churn_per_s"] = churn
+            prv = fields
+        yield name, fields
+
+
+def read_chunks(source: str, baud: int):
+    if source == "-":
+        while chunk := sys.stdin.buffer.read1(4096):
+            yield chunk
+    elif source.startswith("/dev/"):
+        import serial  # pyserial
+
+        with serial.Serial(source, baud, timeout=0.1) as port:
+            while True:
+                yield port.read(4096)
+    else:
+        with open(source, "rb") as f:
+            while chunk := f.read(4096):
+                yield chunk
+
+
+def decode(chunks):
+    # yields (type name, dict of fields) for every valid record
+    buf = bytearray()
+    for chunk in chunks:
+        buf += chunk
+        i = 0
+        while True:
+            i = buf.find(SYNC, i)
+            if i == -1:
+                i = len(buf)
+                break
+            if i + 3 > len(buf):
+                break
+            typ = buf[i + 1]
+            size = buf[i + 2]
+            end = i + 3 + size + 1
+            if end > len(buf):
+                break
+            payload = buf[i + 3 : end - 1]
+            record = RECORDS.get(typ)
+            if (
+                record is None
+                or struct.calcsize(record[1]) != size
+                or (typ + size + sum(payload)) & 0xFF != buf[end - 1]
+            ):
+                # not a record, continue after sync byte
+                i += 1
+                continue
+            name, fmt, fields = record
+            yield name, dict(zip(fields, struct.unpack(fmt, payload)))
+            i = end
+        del buf[:i]
+
+
+def plot(records):
+    import matplotlib.pyplot as plt
+
+    frames = [r for name, r in records if name == "frame"]
+    ms = [r["ms"] for r in frames]
+    plt.plot(ms, [r["frame_us"] for r in frames], label="frame_us")
+    plt.plot(ms, [r["engine_us"] for r in frames], label="engine_us")
+    plt.xlabel("ms")
+    plt.ylabel("us")
+    plt.legend()
+    plt.show()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="decodes telemetry records")
+    parser.add_argument("source", nargs="?", default="-")
+    parser.add_argument("--baud", type=int, default=115200)
+    group = parser.add_mutually_exclusive_group()
+    group.add_argument("--csv", action="store_true", help="print csv per type")
+    group.add_argument("--plot", action="store_true", help="plot frame timings")
+    args = parser.parse_args()
+
+    records = add_churn(decode(read_chunks(args.source, args.baud)))
+    if args.plot:
+        collected = []
+        try:
+            for record in records:
+                collected.append(record)
+        except KeyboardInterrupt:
+            pass
+        plot(collected)
+        return
+
+    headers_printed = set()
+    try:
+        for name, fields in records:
+            if args.csv:
+                if name not in headers_printed:
+                    headers_printed.add(name)
+                    print(name + "," + ",".join(fields.keys()))
+                print(name + "," + ",".join(str(v) for v in fields.values()))
+            else:
+                print(name + " " + "  ".join(f"{k}={v}" for k, v in fields.items()))
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -30,6 +30,22 @@
 #ifdef ESP32_DMA
   // DMA SPA handle
   spi_device_handle_t dmaHAL;
+  // Number of transfers completed, counted by the post transfer callback
+  volatile uint32_t dmaDoneCount = 0;
+  // Number of transfer results collected from the SPI driver
+  uint32_t dmaReclaimedCount = 0;
+  #ifdef ESP32_DMA_QUEUE
+    // Notified of completed transfers, see dmaSetNotifyTask() and dmaSetCallback()
+    volatile TaskHandle_t dmaNotifyTask = nullptr;
+    void (* volatile dmaCallback)(void* arg) = nullptr;
+    void* volatile dmaCallbackArg = nullptr;
+    // Flags of transactions queued by pushPixelsDMAQueued(), see dmaHoldBus()
+    uint32_t dmaQueueFlags = 0;
+    bool dmaBusHeld = false;
+    // Transactions used in order by pushPixelsDMAQueued()
+    spi_transaction_t dmaQueueTrans[TFT_DMA_QUEUE_SIZE];
+    uint8_t dmaQueueIx = 0;
+  #endif
   #ifdef CONFIG_IDF_TARGET_ESP32
     #define DMA_CHANNEL 1
     #ifdef USE_HSPI_PORT
@@ -584,7 +600,7 @@ bool TFT_eSPI::dmaBusy(void)
   for (int i = 0; i < checks; ++i)
   {
     ret = spi_device_get_trans_result(dmaHAL, &rtrans, 0);
-    if (ret == ESP_OK) spiBusyCheck--;
+    if (ret == ESP_OK) { spiBusyCheck--; dmaReclaimedCount++; }
   }
 
   //Serial.print("spiBusyCheck=");Serial.println(spiBusyCheck);
@@ -607,10 +623,139 @@ void TFT_eSPI::dmaWait(void)
     ret = spi_device_get_trans_result(dmaHAL, &rtrans, portMAX_DELAY);
     assert(ret == ESP_OK);
   }
+  dmaReclaimedCount += spiBusyCheck;
   spiBusyCheck = 0;
 }
 
 
+#ifdef ESP32_DMA_QUEUE
+/***************************************************************************************
+** Function name:           dmaQueued
+** Description:             Collect completed transfers and return number not complete
+***************************************************************************************/
+uint8_t TFT_eSPI::dmaQueued(void)
+{
+  if (!DMA_Enabled) return 0;
+  spi_transaction_t *rtrans;
+  esp_err_t ret;
+  // The post transfer callback counts completed transfers so the SPI driver is only
+  // asked for results that are known to be available
+  while (spiBusyCheck && dmaReclaimedCount != dmaDoneCount)
+  {
+    // Result is queued by the driver right after the callback
+    ret = spi_device_get_trans_result(dmaHAL, &rtrans, portMAX_DELAY);
+    assert(ret == ESP_OK);
+    spiBusyCheck--;
+    dmaReclaimedCount++;
+  }
+  return spiBusyCheck;
+}
+
+
+/***************************************************************************************
+** Function name:           dmaWaitQueued
+** Description:             Wait until at most maxQueued transfers are not complete
+***************************************************************************************/
+void TFT_eSPI::dmaWaitQueued(uint8_t maxQueued)
+{
+  if (!DMA_Enabled) return;
+  spi_transaction_t *rtrans;
+  esp_err_t ret;
+  while (spiBusyCheck > maxQueued)
+  {
+    ret = spi_device_get_trans_result(dmaHAL, &rtrans, portMAX_DELAY);
+    assert(ret == ESP_OK);
+    spiBusyCheck--;
+    dmaReclaimedCount++;
+  }
+}
+
+
+/***************************************************************************************
+** Function name:           dmaSetNotifyTask
+** Description:             Set task to notify of every completed transfer
+***************************************************************************************/
+void TFT_eSPI::dmaSetNotifyTask(TaskHandle_t task)
+{
+  dmaNotifyTask = task;
+}
+
+
+/***************************************************************************************
+** Function name:           dmaSetCallback
+** Description:             Set function called in interrupt of every completed transfer
+***************************************************************************************/
+void TFT_eSPI::dmaSetCallback(void (*callback)(void* arg), void* arg)
+{
+  dmaCallback = nullptr; // Not called with previous argument while changing
+  dmaCallbackArg = arg;
+  dmaCallback = callback;
+}
+
+
+/***************************************************************************************
+** Function name:           dmaHoldBus
+** Description:             Hold or release the SPI bus for queued DMA transfers
+***************************************************************************************/
+void TFT_eSPI::dmaHoldBus(bool hold)
+{
+  if (!DMA_Enabled || hold == dmaBusHeld) return;
+  esp_err_t ret;
+  if (hold) {
+    ret = spi_device_acquire_bus(dmaHAL, portMAX_DELAY);
+    assert(ret == ESP_OK);
+    #ifdef SPI_TRANS_CS_KEEP_ACTIVE
+      // Only allowed while the bus is acquired
+      dmaQueueFlags = SPI_TRANS_CS_KEEP_ACTIVE;
+    #endif
+    // IDF versions without SPI_TRANS_CS_KEEP_ACTIVE still toggle CS
+    // between transfers, only the bus arbitration is saved
+  }
+  else {
+    dmaQueueFlags = 0;
+    // The bus can not be released with transfers in progress
+    dmaWaitQueued(0);
+    spi_device_release_bus(dmaHAL);
+  }
+  dmaBusHeld = hold;
+}
+
+
+/***************************************************************************************
+** Function name:           pushPixelsDMAQueued
+** Description:             Queue pixels to TFT (len must be less than 32767)
+***************************************************************************************/
+// This will byte swap the original image if setSwapBytes(true) was called by sketch.
+void TFT_eSPI::pushPixelsDMAQueued(uint16_t* image, uint32_t len)
+{
+  if ((len == 0) || (!DMA_Enabled)) return;
+
+  // Transaction to be used must be complete, transfers complete in the order queued
+  dmaWaitQueued(TFT_DMA_QUEUE_SIZE - 1);
+
+  if(_swapBytes) {
+    for (uint32_t i = 0; i < len; i++) (image[i] = image[i] << 8 | image[i] >> 8);
+  }
+
+  esp_err_t ret;
+  spi_transaction_t& trans = dmaQueueTrans[dmaQueueIx];
+  dmaQueueIx = (dmaQueueIx + 1) % TFT_DMA_QUEUE_SIZE;
+
+  memset(&trans, 0, sizeof(spi_transaction_t));
+
+  trans.user = (void *)1;
+  trans.tx_buffer = image;  //finally send the line data
+  trans.length = len * 16;        //Data length, in bits
+  trans.flags = dmaQueueFlags;    //CS kept active while bus is held
+
+  ret = spi_device_queue_trans(dmaHAL, &trans, portMAX_DELAY);
+  assert(ret == ESP_OK);
+
+  spiBusyCheck++;
+}
+#endif
+
+
 /***************************************************************************************
 ** Function name:           pushPixelsDMA
 ** Description:             Push pixels to TFT (len must be less than 32767)
@@ -769,13 +914,27 @@ void IRAM_ATTR dc_callback(spi_transaction_t *spi_tx)
 
 /***************************************************************************************
 ** Function name:           dma_end_callback
-** Description:             Clear DMA run flag to stop retransmission loop
+** Description:             Clear DMA run flag to stop retransmission loop (not ESP32)
+**                          count completed transfers and issue notifications
 ***************************************************************************************/
 extern "C" void dma_end_callback();
 
 void IRAM_ATTR dma_end_callback(spi_transaction_t *spi_tx)
 {
+#ifndef CONFIG_IDF_TARGET_ESP32
   WRITE_PERI_REG(SPI_DMA_CONF_REG(spi_host), 0);
+#endif
+  dmaDoneCount++;
+#ifdef ESP32_DMA_QUEUE
+  void (*callback)(void* arg) = dmaCallback;
+  if (callback) callback(dmaCallbackArg);
+  TaskHandle_t task = dmaNotifyTask;
+  if (task) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &woken);
+    if (woken) portYIELD_FROM_ISR();
+  }
+#endif
 }
 
 /***************************************************************************************
@@ -819,13 +978,9 @@ bool TFT_eSPI::initDMA(bool ctrl_cs)
     .input_delay_ns = 0,
     .spics_io_num = pin,
     .flags = SPI_DEVICE_NO_DUMMY, //0,
-    .queue_size = 1,
+    .queue_size = TFT_DMA_QUEUE_SIZE, // Outstanding transfers of pushPixelsDMAQueued()
     .pre_cb = 0, //dc_callback, //Callback to handle D/C line
-    #ifdef CONFIG_IDF_TARGET_ESP32
-      .post_cb = 0
-    #else
-      .post_cb = dma_end_callback
-    #endif
+    .post_cb = dma_end_callback // Counts completed transfers
   };
   ret = spi_bus_initialize(spi_host, &buscfg, DMA_CHANNEL);
   ESP_ERROR_CHECK(ret);
@@ -834,6 +989,11 @@ bool TFT_eSPI::initDMA(bool ctrl_cs)
 
   DMA_Enabled = true;
   spiBusyCheck = 0;
+  dmaDoneCount = dmaReclaimedCount = 0;
+  #ifdef ESP32_DMA_QUEUE
+    dmaQueueFlags = 0;
+    dmaBusHeld = false;
+  #endif
   return true;
 }
 
@@ -844,6 +1004,9 @@ bool TFT_eSPI::initDMA(bool ctrl_cs)
 void TFT_eSPI::deInitDMA(void)
 {
   if (!DMA_Enabled) return;
+  #ifdef ESP32_DMA_QUEUE
+    dmaHoldBus(false);
+  #endif
   spi_bus_remove_device(dmaHAL);
   spi_bus_free(spi_host);
   DMA_Enabled = false;
@@ -121,6 +121,11 @@ SPI3_HOST = 2
   #define ESP32_DMA
   // Code to check if DMA is busy, used by SPI DMA + transaction + endWrite functions
   #define DMA_BUSY_CHECK  dmaWait()
+  // Queued DMA transfers, pushPixelsDMAQueued() keeps up to TFT_DMA_QUEUE_SIZE transfers outstanding
+  #define ESP32_DMA_QUEUE
+  #ifndef TFT_DMA_QUEUE_SIZE
+    #define TFT_DMA_QUEUE_SIZE 1
+  #endif
 #else
   #define DMA_BUSY_CHECK
 #endif
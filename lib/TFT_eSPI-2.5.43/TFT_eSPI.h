@@ -795,6 +795,31 @@ class TFT_eSPI : public Print { friend class TFT_eSprite; // Sprite class has ac
   bool     dmaBusy(void); // returns true if DMA is still in progress
   void     dmaWait(void); // wait until DMA is complete
 
+#if defined (ESP32_DMA_QUEUE) // ESP32 SPI only
+           // Push a block of pixels without waiting for earlier transfers to complete. Up to TFT_DMA_QUEUE_SIZE
+           // transfers are outstanding, if the queue is full the function waits for the oldest transfer.
+           // The image buffer must not be changed until its transfer is complete, use dmaQueued() to check this.
+  void     pushPixelsDMAQueued(uint16_t* image, uint32_t len);
+  uint8_t  dmaQueued(void);                      // returns number of transfers not yet complete
+  void     dmaWaitQueued(uint8_t maxQueued);     // wait until at most maxQueued transfers are not complete
+
+           // Completion notifications, issued from the interrupt of every completed DMA transfer.
+           // A task may block in ulTaskNotifyTake() until a transfer completes instead of polling dmaBusy().
+           // The callback must be in IRAM (IRAM_ATTR) and may only use functions that are safe in interrupts.
+           // Use nullptr to disable.
+  void     dmaSetNotifyTask(TaskHandle_t task);
+  void     dmaSetCallback(void (*callback)(void* arg), void* arg = nullptr);
+
+           // Hold the SPI bus for DMA transfers and keep CS active between queued transfers. Consecutive
+           // pushPixelsDMAQueued() transfers then stream without bus arbitration and CS toggling.
+           // Other devices on the same SPI bus and non DMA functions can not be used while the bus is held,
+           // release the bus before calling them, e.g. setAddrWindow(), and hold it again after.
+           // CS is kept active only if the IDF defines SPI_TRANS_CS_KEEP_ACTIVE, otherwise CS toggles
+           // between transfers as when the bus is not held.
+           // When released the CS stays active until the next transfer completes.
+  void     dmaHoldBus(bool hold);
+#endif
+
   bool     DMA_Enabled = false;   // Flag for DMA enabled state
   uint8_t  spiBusyCheck = 0;      // Number of ESP32 transfer buffers to check
 
@@ -0,0 +1,91 @@
+#pragma once
+//
+// asset pack containing palettes, tile and sprite images and tile map
+//
+// file format (little endian):
+// * 'asset_pack_header'
+// * palettes: uint16_t tiles[256], uint16_t sprites[256] at 'palettes_offset'
+// * tile images: uint8_t[tiles_count][image size] at 'tiles_offset'
+// * sprite images: uint8_t[sprite_imgs_count][image size] at
+//   'sprite_imgs_offset'
+// * image size depends on bits per pixel, see 'img_size_B' in 'engine.hpp'
+// * index of image for index in 'sprites.png': uint16_t[sprite_imgs_ix_count]
+//   at 'sprite_imgs_ix_offset', the 2 highest bits being the flip applied to
+//   the image, see 'asset_pack_sprite_flip_shift'
+// * tile map in the format described in 'tile_map_stream.hpp' at
+//   'tile_map_offset'
+// * attributes of tile images: tile_attr[tiles_count] at 'tile_attrs_offset'
+//
+// created by 'game/png-to-resources/make-asset-pack.py'
+//
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+static constexpr uint32_t asset_pack_version = 5;
+
+// flip of sprite image in index of image, bits as 'sprite::flip'
+static constexpr int asset_pack_sprite_flip_shift = 14;
+static constexpr uint16_t asset_pack_sprite_img_ix_mask =
+    (1 << asset_pack_sprite_flip_shift) - 1;
+
+struct asset_pack_header {
+  char magic[4]; // "BAMP"
+  uint32_t version;
+  uint16_t tile_width;
+  uint16_t tile_height;
+  uint16_t sprite_width;
+  uint16_t sprite_height;
+  uint16_t tiles_bpp;
+  uint16_t sprites_bpp;
+  uint32_t tiles_count;
+  uint32_t sprite_imgs_count;
+  uint32_t sprite_imgs_ix_count;
+  uint32_t palettes_offset;
+  uint32_t tiles_offset;
+  uint32_t sprite_imgs_offset;
+  uint32_t sprite_imgs_ix_offset;
+  uint32_t tile_map_offset;
+  uint32_t tile_attrs_offset;
+};
+
+// reads asset pack sections from a file
+// note. no destructor since life-time is program life-time
+class asset_pack_reader {
+  FILE *file_ = nullptr;
+
+public:
+  asset_pack_header header{};
+
+  // opens pack at 'path' and reads the header
+  // returns false if file could not be opened or is not a pack of this version
+  auto open(const char *path) -> bool {
+    close();
+    file_ = fopen(path, "rb");
+    if (!file_) {
+      return false;
+    }
+    if (fread(&header, sizeof(header), 1, file_) != 1 ||
+        memcmp(header.magic, "BAMP", sizeof(header.magic)) ||
+        header.version != asset_pack_version) {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  void close() {
+    if (file_) {
+      fclose(file_);
+      file_ = nullptr;
+    }
+  }
+
+  // reads 'size_B' bytes at 'offset' into 'dst'
+  // returns false if read failed
+  auto read(const uint32_t offset, void *dst, const size_t size_B) -> bool {
+    return file_ && !fseek(file_, long(offset), SEEK_SET) &&
+           fread(dst, 1, size_B, file_) == size_B;
+  }
+};
@@ -0,0 +1,119 @@
+#pragma once
+//
+// line based command console for changing parameters at runtime
+//
+// commands:
+// * 'help' lists the parameters with range and description
+// * 'get' prints the values of all parameters
+// * 'get <name>' prints the value of a parameter
+// * 'set <name> <value>' sets a parameter
+//
+// parameters are declared in a table of 'console_param' by the platform code
+//
+
+#include <cstdio>
+#include <cstring>
+
+struct console_param {
+  char const *name;
+  int min;
+  int max;
+  // returns current value
+  int (*get)();
+  // sets value within 'min' and 'max'
+  // returns false if value is not valid
+  bool (*set)(int value);
+  char const *description;
+};
+
+// 'LineLen' is the maximum length of a command line including terminator
+template <const int LineLen> class console {
+  console_param const *params_;
+  const int params_count_;
+  char line_[LineLen]{};
+  int line_len_ = 0;
+  // true if line is too long and is discarded at next new line
+  bool overflow_ = false;
+
+  auto find(char const *name) const -> console_param const * {
+    for (int i = 0; i < params_count_; i++) {
+      if (!strcmp(params_[i].name, name)) {
+        return &params_[i];
+      }
+    }
+    printf("!!! unknown parameter '%s'\n", name);
+    return nullptr;
+  }
+
+  void print(console_param const &p) const {
+    printf("%s = %d\n", p.name, p.get());
+  }
+
+  void execute() {
+    char cmd[8]{};
+    char name[24]{};
+    int value = 0;
+    const int n = sscanf(line_, "%7s %23s %d", cmd, name, &value);
+    if (n <= 0) {
+      // empty line
+      return;
+    }
+    if (!strcmp(cmd, "help")) {
+      for (int i = 0; i < params_count_; i++) {
+        console_param const &p = params_[i];
+        printf("%s [%d..%d]: %s\n", p.name, p.min, p.max, p.description);
+      }
+      return;
+    }
+    if (!strcmp(cmd, "get")) {
+      if (n == 1) {
+        for (int i = 0; i < params_count_; i++) {
+          print(params_[i]);
+        }
+        return;
+      }
+      console_param const *p = find(name);
+      if (p) {
+        print(*p);
+      }
+      return;
+    }
+    if (!strcmp(cmd, "set") && n == 3) {
+      console_param const *p = find(name);
+      if (!p) {
+        return;
+      }
+      if (value < p->min || value > p->max || !p->set(value)) {
+        printf("!!! invalid value %d for '%s'\n", value, p->name);
+        return;
+      }
+      print(*p);
+      return;
+    }
+    printf("!!! usage: help | get [name] | set <name> <value>\n");
+  }
+
+public:
+  console(console_param const *params, const int params_count)
+      : params_{params}, params_count_{params_count} {}
+
+  // adds a received character and executes the line at new line
+  void feed(const char c) {
+    if (c == '\r' || c == '\n') {
+      line_[line_len_] = '\0';
+      if (overflow_) {
+        printf("!!! command line too long\n");
+      } else {
+        execute();
+      }
+      line_len_ = 0;
+      overflow_ = false;
+      return;
+    }
+    if (line_len_ == LineLen - 1) {
+      overflow_ = true;
+      return;
+    }
+    line_[line_len_++] = c;
+  }
+};
@@ -7,8 +7,12 @@
 // include platform constants
 #include "platform.hpp"
 
+#include "asset_pack.hpp"
 #include "o1store.hpp"
+#include "profiler.hpp"
+#include "tile_map_stream.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <limits>
@@ -16,60 +20,700 @@
 // palette used when rendering tiles
 // converts uint8_t to uint16_t rgb 565 (red being the highest bits)
 // note. lower and higher byte swapped
-static constexpr uint16_t palette_tiles[256]{
+// note. palettes are in DRAM and may be replaced by an asset pack
+static uint16_t palette_tiles[256]{
 #include "game/resources/palette_tiles.hpp"
 };
 
-// palette used when rendering sprites
-static constexpr uint16_t palette_sprites[256]{
+// palette banks used when rendering sprites selected by 'sprite::palette'
+// note. banks other than 0 are copied from bank 0 at 'engine_setup()' and
+//       after loading an asset pack
+static uint16_t palette_sprites[sprites_palette_banks][256]{{
 #include "game/resources/palette_sprites.hpp"
+}};
+
+// copies palette bank 0 to the other banks
+static void palette_sprites_copy_banks() {
+  for (int i = 1; i < sprites_palette_banks; i++) {
+    memcpy(palette_sprites[i], palette_sprites[0], sizeof(palette_sprites[0]));
+  }
+}
+
+// returns number of shifts to convert a 2^n number to 1
+static constexpr int count_right_shifts_until_1(int num) {
+  return (num <= 1) ? 0 : 1 + count_right_shifts_until_1(num >> 1);
+}
+
+// size of image in bytes with 8 or 4 bits per pixel
+// note. 4 bits per pixel image is 16 bytes sub-palette with indexes in palette
+//       followed by 2 pixels per byte, low nibble first
+static constexpr int img_size_B(const int width, const int height,
+                                const int bpp) {
+  return bpp == 4 ? 16 + width * height / 2 : width * height;
+}
+
+static constexpr int tile_img_size_B =
+    img_size_B(tile_width, tile_height, tiles_bpp);
+
+static constexpr int sprite_img_size_B =
+    img_size_B(sprite_width, sprite_height, sprites_bpp);
+
+static_assert(tiles_bpp == 8 || tiles_bpp == 4, "tiles_bpp must be 8 or 4");
+static_assert(sprites_bpp == 8 || sprites_bpp == 4,
+              "sprites_bpp must be 8 or 4");
+
+// returns palette index of pixel 'ix' in image 'img' with 'Bpp' bits per pixel
+template <const int Bpp>
+static inline auto img_pixel(uint8_t const *img, const int ix) -> uint8_t {
+  if (Bpp == 4) {
+    return img[(img[16 + (ix >> 1)] >> ((ix & 1) << 2)) & 0xf];
+  }
+  return img[ix];
+}
+
+// images used by tile map in program memory
+// note. generated by 'png-to-resources/compile-assets.py' with only the images
+//       used by the tile map
+static constexpr uint8_t tiles_progmem[][tile_img_size_B]{
+#include "game/resources/tiles.hpp"
 };
 
+static constexpr int tiles_progmem_count =
+    sizeof(tiles_progmem) / sizeof(tiles_progmem[0]);
+
+static_assert(tiles_progmem_count <= tiles_count,
+              "tiles in 'resources/tiles.hpp' exceed 'tiles_count'");
+
 // images used by tile map
-static constexpr uint8_t tiles[tiles_count][tile_width * tile_height]{
-#include "game/resources/tiles.hpp"
+// note. points to 'tiles_progmem' or images loaded from an asset pack
+static uint8_t const (*tiles)[tile_img_size_B] = tiles_progmem;
+
+// attributes of tile images in program memory
+// note. generated by 'png-to-resources/compile-assets.py' from
+//       'png-to-resources/tile-attributes.txt'
+static constexpr tile_attr tile_attrs_progmem[]{
+#include "game/resources/tile_attrs.hpp"
+};
+
+static_assert(sizeof(tile_attrs_progmem) / sizeof(tile_attrs_progmem[0]) ==
+                  tiles_progmem_count,
+              "'resources/tile_attrs.hpp' does not match "
+              "'resources/tiles.hpp'");
+
+static_assert(sizeof(tile_attr) == 1,
+              "asset pack stores tile attributes as 8 bits");
+
+// attributes of tile images
+// note. points to 'tile_attrs_progmem' or attributes loaded from an asset pack
+static tile_attr const *tile_attrs = tile_attrs_progmem;
+
+// run-length encoded tile map generated from 'resources/tile_map.hpp'
+static constexpr tile_ix tile_map_rle[]{
+#include "game/resources/tile_map_rle.hpp"
 };
 
-// initial tile map
-static tile_ix tile_map[tile_map_height][tile_map_width]{
-#include "game/resources/tile_map.hpp"
+// offsets of rows in 'tile_map_rle'
+static constexpr uint32_t tile_map_rle_rows[tile_map_height + 1]{
+#include "game/resources/tile_map_rle_rows.hpp"
 };
 
+static tile_map_source_rle<tile_ix, tile_map_width> tile_map_rle_source{
+    tile_map_rle, tile_map_rle_rows, tile_map_height, tiles_progmem_count};
+
+// number of tile map rows that might be visible on screen
+static constexpr int tile_map_visible_rows =
+    (display_height + tile_height - 1) / tile_height + 1;
+
+static_assert(tile_map_rows_buffered >= tile_map_visible_rows,
+              "tile_map_rows_buffered must fit rows visible on screen");
+
+// tile map rows around the screen decoded from source when scrolled into view
+// note. source is 'tile_map_rle_source' unless set otherwise at 'main_setup()'
+static tile_map_stream<tile_ix, tile_map_width, tile_map_rows_buffered>
+    tile_map{};
+
 // tile map controls
 static float tile_map_x = 0;
 static float tile_map_dx = 0;
 static float tile_map_y = 0;
 static float tile_map_dy = 0;
 
-// images used by sprites
-static constexpr uint8_t sprite_imgs[sprite_imgs_count]
-                                    [sprite_width * sprite_height]{
+// resolution of rendering applied from next frame
+static render_resolution rendering_resolution = render_resolution_default;
+
+// features that may be switched at runtime, e.g. from the serial console in
+// 'main.cpp' to compare performance on device
+// note. no collisions are detected or reported when 'collisions_enabled' is
+//       false
+static bool collisions_enabled = true;
+// note. in effect if 'partial_frames' in 'defs.hpp' is true
+static bool partial_frames_enabled = true;
+// note. in effect if 'tile_scanline_cache_lines' in 'defs.hpp' is not 0
+static bool tile_scanline_cache_enabled = true;
+
+// number of shifts to convert between pixels and tiles
+static constexpr int tile_width_shift = count_right_shifts_until_1(tile_width);
+static constexpr int tile_height_shift =
+    count_right_shifts_until_1(tile_height);
+
+// returns attributes of tile at 'tile_x', 'tile_y' in tile map or 0 if outside
+// the tile map or the rows visible on screen
+static inline auto tile_map_attrs(const int tile_x, const int tile_y)
+    -> tile_attr {
+  if (tile_x < 0 || tile_x >= tile_map_width || !tile_map.is_visible(tile_y)) {
+    return 0;
+  }
+  return tile_attrs[tile_map.row(tile_y)[tile_x]];
+}
+
+// returns attributes bitwise AND 'mask' of tiles overlapped by box in screen
+// coordinates
+// 'hit_x' and 'hit_y' are set to screen coordinates of the top left of the
+// first matching tile
+static auto tile_map_box_attrs(const int x, const int y, const int width,
+                               const int height, const tile_attr mask,
+                               int &hit_x, int &hit_y) -> tile_attr {
+  const int map_x = int(tile_map_x);
+  const int map_y = int(tile_map_y);
+  const int tx_bgn = (map_x + x) >> tile_width_shift;
+  const int tx_end = (map_x + x + width - 1) >> tile_width_shift;
+  const int ty_bgn = (map_y + y) >> tile_height_shift;
+  const int ty_end = (map_y + y + height - 1) >> tile_height_shift;
+  tile_attr attrs = 0;
+  for (int ty = ty_bgn; ty <= ty_end; ty++) {
+    for (int tx = tx_bgn; tx <= tx_end; tx++) {
+      const tile_attr a = tile_attr(tile_map_attrs(tx, ty) & mask);
+      if (a && !attrs) {
+        hit_x = (tx << tile_width_shift) - map_x;
+        hit_y = (ty << tile_height_shift) - map_y;
+      }
+      attrs = tile_attr(attrs | a);
+    }
+  }
+  return attrs;
+}
+
+// result of 'tile_map_sweep(...)'
+struct tile_map_hit {
+  // fraction of movement before contact
+  float t;
+  // attributes of tiles in contact bitwise AND mask
+  tile_attr attrs;
+  // screen coordinates of top left of first tile in contact
+  int16_t x;
+  int16_t y;
+};
+
+// moves box in screen coordinates by 'dx', 'dy' and finds first contact with
+// tiles with attributes matching 'mask'
+// returns true if contact was found with details in 'hit'
+// note. steps one pixel along the major axis, typically a few steps per frame
+static auto tile_map_sweep(const float x, const float y, const int width,
+                           const int height, const float dx, const float dy,
+                           const tile_attr mask, tile_map_hit &hit) -> bool {
+  const float dx_abs = dx < 0 ? -dx : dx;
+  const float dy_abs = dy < 0 ? -dy : dy;
+  const int steps = int(dx_abs > dy_abs ? dx_abs : dy_abs) + 1;
+  for (int i = 0; i <= steps; i++) {
+    const float t = float(i) / float(steps);
+    int hit_x = 0;
+    int hit_y = 0;
+    const tile_attr attrs =
+        tile_map_box_attrs(int(x + dx * t), int(y + dy * t), width, height,
+                           mask, hit_x, hit_y);
+    if (attrs) {
+      hit = {i ? float(i - 1) / float(steps) : 0, attrs, int16_t(hit_x),
+             int16_t(hit_y)};
+      return true;
+    }
+  }
+  return false;
+}
+
+// images used by sprites in program memory
+// note. generated by 'png-to-resources/compile-assets.py' without images that
+//       are unused, duplicates or flipped copies
+// note. aligned so that the 2 lowest bits of the address of an image are free
+//       to carry its flip, see 'sprite_img_flip(...)'
+alignas(4) static constexpr uint8_t
+    sprite_imgs_progmem[][sprite_img_size_B]{
 #include "game/resources/sprite_imgs.hpp"
-                                    };
+};
+
+static_assert(sprite_img_size_B % 4 == 0,
+              "sprite_img_size_B must keep images aligned to 4 bytes");
+
+// index in 'sprite_imgs_progmem' of image at index in 'sprites.png'
+static constexpr sprite_img_ix sprite_imgs_progmem_ix[sprite_imgs_count]{
+#include "game/resources/sprite_imgs_ix.hpp"
+};
 
-// the reserved 'sprite_ix' in 'collision_map' representing 'no sprite pixel'
+// flip applied to image at index in 'sprites.png', bits as 'sprite::flip'
+static constexpr uint8_t sprite_imgs_progmem_flip[sprite_imgs_count]{
+#include "game/resources/sprite_imgs_flip.hpp"
+};
+
+static constexpr int sprite_imgs_progmem_count =
+    sizeof(sprite_imgs_progmem) / sizeof(sprite_imgs_progmem[0]);
+
+// opacity of a row of pixels in a sprite image, bit 0 being the leftmost pixel
+using sprite_row_mask = uint32_t;
+
+static_assert(sprite_width <= 32, "sprite_row_mask must fit sprite_width bits");
+
+// mask with 'sprite_width' bits set
+static constexpr sprite_row_mask sprite_row_mask_all =
+    sprite_row_mask(~sprite_row_mask(0) >> (32 - sprite_width));
+
+// returns 'mask' with order of 'sprite_width' bits reversed
+static inline auto sprite_row_mask_reversed(sprite_row_mask mask)
+    -> sprite_row_mask {
+  mask = ((mask >> 1) & 0x55555555) | ((mask & 0x55555555) << 1);
+  mask = ((mask >> 2) & 0x33333333) | ((mask & 0x33333333) << 2);
+  mask = ((mask >> 4) & 0x0f0f0f0f) | ((mask & 0x0f0f0f0f) << 4);
+  mask = ((mask >> 8) & 0x00ff00ff) | ((mask & 0x00ff00ff) << 8);
+  mask = (mask >> 16) | (mask << 16);
+  return mask >> (32 - sprite_width);
+}
+
+// returns flip of sprite image returned by 'sprite_imgs', bits as
+// 'sprite::flip', applied to the pixels of the image before the flip of the
+// sprite
+static inline auto sprite_img_flip(uint8_t const *img) -> int {
+  return int(uintptr_t(img) & 3);
+}
+
+// returns pixels of sprite image returned by 'sprite_imgs'
+static inline auto sprite_img_data(uint8_t const *img) -> uint8_t const * {
+  return img - sprite_img_flip(img);
+}
+
+// images used by sprites indexed by position in 'sprites.png'
+// note. uses images in program memory or images loaded from an asset pack
+// note. an image that is a flipped copy of another is returned as the address
+//       of the other plus the flip, see 'sprite_img_flip(...)'
+class sprite_imgs final {
+  uint8_t const (*imgs_)[sprite_img_size_B] = nullptr;
+  sprite_img_ix const *ix_ = nullptr;
+  uint8_t const *flip_ = nullptr;
+  // opacity masks of rows of images if 'collision_detection' uses masks
+  sprite_row_mask (*masks_)[sprite_height] = nullptr;
+
+  void update_masks(const int count) {
+    if (collision_detection != collision_detector_masks) {
+      return;
+    }
+    free(masks_);
+    masks_ = static_cast<sprite_row_mask(*)[sprite_height]>(
+        calloc(size_t(count), sizeof(masks_[0])));
+    if (!masks_) {
+      printf("!!! sprite_imgs: could not allocate masks\n");
+      exit(1);
+    }
+    for (int i = 0; i < count; i++) {
+      for (int y = 0; y < sprite_height; y++) {
+        sprite_row_mask mask = 0;
+        for (int x = 0; x < sprite_width; x++) {
+          if (img_pixel<sprites_bpp>(imgs_[i], y * sprite_width + x)) {
+            mask |= sprite_row_mask(1) << x;
+          }
+        }
+        masks_[i][y] = mask;
+      }
+    }
+  }
+
+public:
+  sprite_imgs(uint8_t const (*imgs)[sprite_img_size_B],
+              sprite_img_ix const *ix, uint8_t const *flip, const int count)
+      : imgs_{imgs}, ix_{ix}, flip_{flip} {
+    update_masks(count);
+  }
+
+  // sets 'count' images and tables of index in 'imgs' and flip for index in
+  // 'sprites.png'
+  // note. images must be aligned to 4 bytes
+  void set(uint8_t const (*imgs)[sprite_img_size_B], sprite_img_ix const *ix,
+           uint8_t const *flip, const int count) {
+    imgs_ = imgs;
+    ix_ = ix;
+    flip_ = flip;
+    update_masks(count);
+  }
+
+  // returns opacity mask of row 'y' of image 'img' considering its flip
+  // note. 'img' must be an image returned by this instance and
+  //       'collision_detection' must use masks
+  inline auto row_mask(uint8_t const *img, const int y) const
+      -> sprite_row_mask {
+    const int flip = sprite_img_flip(img);
+    const sprite_row_mask mask =
+        masks_[(sprite_img_data(img) - imgs_[0]) / sprite_img_size_B]
+              [flip & 2 ? sprite_height - 1 - y : y];
+    return flip & 1 ? sprite_row_mask_reversed(mask) : mask;
+  }
+
+  // returns image at index 'ix' in 'sprites.png'
+  // note. address carries flip of image, see 'sprite_img_flip(...)'
+  inline auto operator[](const int ix) const -> uint8_t const * {
+    return imgs_[ix_[ix]] + flip_[ix];
+  }
+
+  // sets 'dst' to the images of a region of 'w' x 'h' cells in row-major
+  // order with top left image at index 'ix' in 'sprites.png'
+  void region(const int ix, const int w, const int h,
+              uint8_t const **dst) const {
+    for (int y = 0; y < h; y++) {
+      for (int x = 0; x < w; x++) {
+        *dst++ = (*this)[ix + y * sprite_imgs_per_row + x];
+      }
+    }
+  }
+} static sprite_imgs{sprite_imgs_progmem, sprite_imgs_progmem_ix,
+                     sprite_imgs_progmem_flip, sprite_imgs_progmem_count};
+
+// the reserved 'sprite_ix' in 'collision_row' representing 'no sprite pixel'
 static constexpr sprite_ix sprite_ix_reserved =
     std::numeric_limits<sprite_ix>::max();
 
+static_assert(sprites_count <= int(sprite_ix_reserved),
+              "sprites_count must be less than maximum value of sprite_ix");
+
 // forward declaration of type
 class object;
 
+// collision shape of object used to detect collisions
+// * pixel: pixels of sprites on screen detected while rendering
+// * aabb: bounding box of sprites
+// * circle: circle inscribed in bounding box of sprites
+// note. 'aabb' and 'circle' are detected by 'spatial_hash' without cost during
+//       rendering, also off screen
+// note. collision between 'pixel' and other mode uses bounding box of the
+//       'pixel' object
+enum collision_mode : uint8_t {
+  col_mode_pixel,
+  col_mode_aabb,
+  col_mode_circle
+};
+
+// value of 'sprite::tile_col_x' when the sprite has no previous position
+static constexpr int16_t tile_col_none = std::numeric_limits<int16_t>::min();
+
 class sprite {
 public:
   sprite **alloc_ptr = nullptr;
   object *obj = nullptr;
   uint8_t const *img = nullptr;
+  // note. image of 1 x 1 sprite or top left cell, 'nullptr' if not rendered
+  //       images from 'sprite_imgs' carry their own flip applied before
+  //       'flip', see 'sprite_img_flip(...)'
+  uint8_t const *const *imgs = nullptr;
+  // note. images of 'w' x 'h' cells in row-major order, e.g. from
+  //       'sprite_imgs.region(...)', used when sprite is larger than 1 x 1
   int16_t scr_x = 0;
   int16_t scr_y = 0;
+  uint8_t w = 1;
+  uint8_t h = 1;
+  // note. dimensions in cells of 'sprite_width' x 'sprite_height' pixels
   uint8_t layer = 0;
   // note. lower 'layer' number is rendered first
   //       number of layers specified by 'sprites_layers'
   uint8_t flip = 0; // bits: horiz: 0b01, vert: 0b10
+  uint8_t palette = 0;
+  // note. index of palette bank in 'palette_sprites' used when rendering
+  int16_t rendered_x = 0;
+  int16_t rendered_y = 0;
+  uint8_t rendered_w = 0;
+  uint8_t rendered_h = 0;
+  uint32_t rendered_sig = 0;
+  // note. bounds and hash of appearance when last rendered, used by
+  //       'frame_damage', 'rendered_sig' is 0 if not rendered
+  int16_t tile_col_x = tile_col_none;
+  int16_t tile_col_y = 0;
+  // note. screen position at previous 'tile_map_collisions()' from where the
+  //       movement is swept against the tiles
 };
 
 using sprites_store = o1store<sprite, sprites_count, 1>;
 
-static sprites_store sprites{};
+class sprites final : public sprites_store {
+public:
+  // allocates sprite with default attributes
+  // note. attributes of a previously freed sprite, such as 'imgs' pointing
+  //       into a deallocated object, are not carried over
+  auto allocate_instance() -> sprite * {
+    sprite *spr = sprites_store::allocate_instance();
+    if (spr) {
+      sprite const prv = *spr;
+      *spr = sprite{};
+      spr->alloc_ptr = prv.alloc_ptr;
+      // note. keep what was last rendered in the slot for 'frame_damage'
+      spr->rendered_x = prv.rendered_x;
+      spr->rendered_y = prv.rendered_y;
+      spr->rendered_w = prv.rendered_w;
+      spr->rendered_h = prv.rendered_h;
+      spr->rendered_sig = prv.rendered_sig;
+    }
+    return spr;
+  }
+} static sprites{};
+
+// number of scanlines in a band of 'frame_damage'
+static constexpr int damage_band_height = 8;
+
+// areas of the screen that changed since previous frame used for partial
+// frame updates, see 'partial_frames' in 'defs.hpp'
+// * tracked in bands of 'damage_band_height' scanlines with the horizontal
+//   extent of the changes
+// * sprites add previous and current bounds when moved, changed appearance,
+//   appeared or disappeared
+// * tiles changed with 'tile_map_set(...)'
+// * the whole screen when scrolled or rendering resolution changed
+// note. game code changing palettes or tiles directly should call 'add(...)'
+//       or 'add_full()'
+class frame_damage {
+  static constexpr int bands_count =
+      (display_height + damage_band_height - 1) / damage_band_height;
+
+  int16_t x_[bands_count];
+  int16_t x_end_[bands_count];
+  bool full_ = true;
+  // state of previous frame
+  int prv_x_ = 0;
+  int prv_y_ = 0;
+  render_resolution prv_resolution_ = render_resolution_default;
+
+  // returns hash of what the sprite looks like
+  static auto signature(sprite const *spr) -> uint32_t {
+    uint32_t sig = 2166136261u;
+    const int n = spr->imgs ? spr->w * spr->h : 1;
+    uint8_t const *const *cells = spr->imgs ? spr->imgs : &spr->img;
+    for (int i = 0; i < n; i++) {
+      sig = (sig ^ uint32_t(uintptr_t(cells[i]))) * 16777619u;
+    }
+    sig = (sig ^ uint32_t(spr->flip | spr->palette << 2 | spr->layer << 10)) *
+          16777619u;
+    // note. non-zero since 0 means not rendered
+    return sig | 1;
+  }
+
+  // adds areas of sprites that changed since previous frame
+  void add_sprites() {
+    sprite *spr = sprites.all_list();
+    const int len = sprites.all_list_len();
+    for (int i = 0; i < len; i++, spr++) {
+      const bool on_screen =
+          spr->img && spr->scr_y > -spr->h * sprite_height &&
+          spr->scr_y < display_height && spr->scr_x > -spr->w * sprite_width &&
+          spr->scr_x < display_width;
+      if (!on_screen) {
+        if (spr->rendered_sig) {
+          // disappeared
+          add(spr->rendered_x, spr->rendered_y,
+              spr->rendered_w * sprite_width, spr->rendered_h * sprite_height);
+          spr->rendered_sig = 0;
+        }
+        continue;
+      }
+      const uint32_t sig = signature(spr);
+      if (sig == spr->rendered_sig && spr->scr_x == spr->rendered_x &&
+          spr->scr_y == spr->rendered_y && spr->w == spr->rendered_w &&
+          spr->h == spr->rendered_h) {
+        // unchanged
+        continue;
+      }
+      if (spr->rendered_sig) {
+        add(spr->rendered_x, spr->rendered_y, spr->rendered_w * sprite_width,
+            spr->rendered_h * sprite_height);
+      }
+      add(spr->scr_x, spr->scr_y, spr->w * sprite_width,
+          spr->h * sprite_height);
+      spr->rendered_x = spr->scr_x;
+      spr->rendered_y = spr->scr_y;
+      spr->rendered_w = spr->w;
+      spr->rendered_h = spr->h;
+      spr->rendered_sig = sig;
+    }
+  }
+
+public:
+  frame_damage() {
+    clear();
+    full_ = true;
+  }
+
+  // clears damage after a frame has been rendered
+  void clear() {
+    for (int i = 0; i < bands_count; i++) {
+      x_[i] = display_width;
+      x_end_[i] = 0;
+    }
+    full_ = false;
+  }
+
+  // adds area in screen coordinates
+  void add(int x, int y, const int width, const int height) {
+    int x_end = x + width;
+    int y_end = y + height;
+    x = x < 0 ? 0 : x;
+    y = y < 0 ? 0 : y;
+    x_end = x_end > display_width ? display_width : x_end;
+    y_end = y_end > display_height ? display_height : y_end;
+    if (x >= x_end || y >= y_end) {
+      return;
+    }
+    const int band_end = (y_end - 1) / damage_band_height;
+    for (int i = y / damage_band_height; i <= band_end; i++) {
+      if (x < x_[i]) {
+        x_[i] = int16_t(x);
+      }
+      if (x_end > x_end_[i]) {
+        x_end_[i] = int16_t(x_end);
+      }
+    }
+  }
+
+  // adds the whole screen
+  void add_full() { full_ = true; }
+
+  // adds changes of sprites and scrolling since previous frame where 'x' and
+  // 'y' are the position of the screen in the tile map
+  void update(const int x, const int y) {
+    if (x != prv_x_ || y != prv_y_ ||
+        rendering_resolution != prv_resolution_) {
+      prv_x_ = x;
+      prv_y_ = y;
+      prv_resolution_ = rendering_resolution;
+      full_ = true;
+    }
+    // note. sprites are tracked also when full to be up to date next frame
+    add_sprites();
+  }
+
+  auto is_full() const -> bool { return full_; }
+
+  // returns number of damaged pixels counting the extent of each band
+  auto area() const -> int {
+    int area = 0;
+    for (int i = 0; i < bands_count; i++) {
+      if (x_end_[i] > x_[i]) {
+        area += (x_end_[i] - x_[i]) * damage_band_height;
+      }
+    }
+    return area;
+  }
+
+  // returns true if band 'ix' is damaged and sets 'x' and 'x_end' to the
+  // horizontal extent
+  auto band(const int ix, int &x, int &x_end) const -> bool {
+    x = x_[ix];
+    x_end = x_end_[ix];
+    return x < x_end;
+  }
+} static frame_damage{};
+
+// scanlines of the tile map rendered from tiles only, reused across frames
+// see 'tile_scanline_cache_lines' in 'defs.hpp'
+// * a line is cached while it is on screen, lines that left the screen are
+//   dropped at start of frame since the tile map row may be reloaded
+// * lines are keyed by tile map scanline, all with the same horizontal
+//   position and resolution
+// note. game code changing palettes or tile images should call 'clear()'
+class tile_scanline_cache {
+  // note. 'tile_scanline_cache_lines' is at least 1 to compile
+  static constexpr int lines_max =
+      tile_scanline_cache_lines ? tile_scanline_cache_lines : 1;
+
+  // lines allocated at setup
+  uint16_t *lines_[lines_max]{};
+  // tile map scanline of cached line or -1 if none
+  int lines_y_[lines_max];
+  int lines_count_ = 0;
+  // key of all cached lines
+  int x_ = -1;
+  int x_shift_ = -1;
+
+public:
+  tile_scanline_cache() { clear(); }
+
+  // adds an allocated line of 'display_width' pixels
+  // returns false if at maximum number of lines
+  auto add_line(uint16_t *line) -> bool {
+    if (!tile_scanline_cache_lines || lines_count_ == lines_max) {
+      return false;
+    }
+    lines_[lines_count_++] = line;
+    return true;
+  }
+
+  auto lines_count() const -> int { return lines_count_; }
+
+  void clear() {
+    for (int i = 0; i < lines_max; i++) {
+      lines_y_[i] = -1;
+    }
+  }
+
+  // starts a frame with screen at 'x', 'y' in the tile map rendered with
+  // 'x_shift' as 'render_x_shift' in 'main.cpp'
+  void begin_frame(const int x, const int y, const int x_shift) {
+    if (x != x_ || x_shift != x_shift_) {
+      x_ = x;
+      x_shift_ = x_shift;
+      clear();
+      return;
+    }
+    for (int i = 0; i < lines_count_; i++) {
+      if (lines_y_[i] < y || lines_y_[i] >= y + display_height) {
+        lines_y_[i] = -1;
+      }
+    }
+  }
+
+  // returns line of tile map scanline 'y' and sets 'cached' true if it holds
+  // the rendered scanline, false if it should be rendered
+  // returns nullptr if the slot is used by another line on screen
+  auto line(const int y, bool &cached) -> uint16_t * {
+    if (!lines_count_) {
+      return nullptr;
+    }
+    const int slot = y % lines_count_;
+    if (lines_y_[slot] == y) {
+      cached = true;
+      return lines_[slot];
+    }
+    if (lines_y_[slot] != -1) {
+      return nullptr;
+    }
+    lines_y_[slot] = y;
+    cached = false;
+    return lines_[slot];
+  }
+
+  // drops lines of tile map row 'tile_y'
+  void clear_row(const int tile_y) {
+    for (int i = 0; i < lines_count_; i++) {
+      if (lines_y_[i] >> tile_height_shift == tile_y) {
+        lines_y_[i] = -1;
+      }
+    }
+  }
+} static tile_scanline_cache{};
+
+// sets tile at 'tile_x', 'tile_y' in tile map and adds it to 'frame_damage'
+// returns false if outside the tile map or the rows visible on screen
+static auto tile_map_set(const int tile_x, const int tile_y, const tile_ix t)
+    -> bool {
+  if (tile_x < 0 || tile_x >= tile_map_width || !tile_map.is_visible(tile_y)) {
+    return false;
+  }
+  tile_map.row(tile_y)[tile_x] = t;
+  tile_scanline_cache.clear_row(tile_y);
+  frame_damage.add((tile_x << tile_width_shift) - int(tile_map_x),
+                   (tile_y << tile_height_shift) - int(tile_map_y), tile_width,
+                   tile_height);
+  return true;
+}
 
 class object {
 public:
@@ -77,18 +721,42 @@ public:
   // note. no default value since it would overwrite the 'o1store' assigned
   //       value at 'allocate_instance()'
 
-  object *col_with = nullptr;
   collision_bits col_bits = 0;
   collision_bits col_mask = 0;
   // note. used to declare interest in collisions with objects whose
   //       'col_bits' bitwise AND with this 'col_mask' is not 0
 
+  collision_mode col_mode = col_mode_pixel;
+
+  tile_attr col_tile_mask = 0;
+  // note. used to declare interest in collisions with tiles whose attributes
+  //       bitwise AND with this 'col_tile_mask' is not 0
+
+  // true if object has died from a collision and will be deallocated without
+  // calling 'update()'
+  bool dead = false;
+
   virtual ~object() {}
   // note. 'delete obj' is not allowed since memory is managed by 'o1store'
 
+  // parameters in order: 'obj', 'x', 'y', 'tile_attrs'
+  // called once for every object 'obj' in collision with this object during
+  // the frame with screen coordinates 'x', 'y' of first pixel in contact and
+  // 'tile_attrs' 'ta_none'
+  // called once during the frame with 'obj' 'nullptr' if a sprite of the
+  // object overlaps tiles with attributes matching 'col_tile_mask' with the
+  // matching attributes of the tiles in 'tile_attrs' and screen coordinates
+  // 'x', 'y' of top left of first tile found
+  // returns true if object has died
+  // note. called before 'update()' on objects
+  // note. 'obj' may have died in the same frame but is deallocated after all
+  //       collisions have been handled
+  virtual auto on_collision_with(object *, int16_t, int16_t, tile_attr)
+      -> bool {
+    return false;
+  }
+
   // returns true if object has died
-  // note. regarding classes overriding 'update(...)'
-  //       after 'update(...)' 'col_with' should be 'nullptr'
   virtual auto update() -> bool { return false; }
 
   // called before rendering the sprites
@@ -106,7 +774,7 @@ public:
     //       allocate new objects in the loop and that would change the 'end'
     for (object **it = allocated_list(); it < end; it++) {
       object *obj = *it;
-      if (obj->update()) {
+      if (obj->dead || obj->update()) {
         obj->~object();
         free_instance(obj);
       }
@@ -124,6 +792,426 @@ public:
   }
 } static objects{};
 
+// collisions detected during a frame, each pair of objects once with the
+// first pixel in contact
+// * preallocated list of 'collisions_count' pairs in order of detection
+// * open addressing hash table of pairs for de-duplication
+// * dispatched ordered by the objects in the pair so that game outcomes do
+//   not depend on the order of detection, e.g. 'rendering_order'
+// note. collisions exceeding 'collisions_count' in a frame are dropped
+class collisions final {
+  // note. 'obj2' is 'nullptr' for collision of 'obj1' with tiles
+  struct pair {
+    object *obj1;
+    object *obj2;
+    int16_t x;
+    int16_t y;
+    tile_attr attrs;
+    // index in 'table_' used for clearing the table
+    int16_t table_ix;
+    // bits: 'obj1' is notified: 0b01, 'obj2' is notified: 0b10
+    uint8_t notify;
+  };
+
+  static constexpr int table_size = 2 * collisions_count;
+  static_assert((table_size & (table_size - 1)) == 0,
+                "collisions_count must be a power of 2");
+
+  pair pairs_[collisions_count];
+  int pairs_len_ = 0;
+  // index in 'pairs_' or -1 if free
+  int16_t table_[table_size];
+
+  // returns pair 'obj1', 'obj2' or adds it if there is room
+  // returns 'nullptr' if there is no room
+  auto find_or_add(object *obj1, object *obj2, const int16_t x,
+                   const int16_t y) -> pair * {
+    // note. instances are at least 8 B aligned
+    const uintptr_t hash = (uintptr_t(obj1) >> 3) * 31 + (uintptr_t(obj2) >> 3);
+    int table_ix = int(hash & (table_size - 1));
+    while (table_[table_ix] != -1) {
+      pair &p = pairs_[table_[table_ix]];
+      if (p.obj1 == obj1 && p.obj2 == obj2) {
+        return &p;
+      }
+      table_ix = (table_ix + 1) & (table_size - 1);
+    }
+    if (pairs_len_ == collisions_count) {
+      return nullptr;
+    }
+    table_[table_ix] = int16_t(pairs_len_);
+    pairs_[pairs_len_] = {obj1, obj2, x, y, 0, int16_t(table_ix), 0};
+    return &pairs_[pairs_len_++];
+  }
+
+public:
+  collisions() {
+    for (int i = 0; i < table_size; i++) {
+      table_[i] = -1;
+    }
+  }
+
+  // adds collision between 'obj1' and 'obj2' at screen coordinates 'x', 'y'
+  // where 'obj1_notify' and 'obj2_notify' are true if the object is interested
+  // in the collision
+  // note. if the pair has been added during the frame only the interest is
+  //       updated
+  void add(object *obj1, object *obj2, const int16_t x, const int16_t y,
+           const bool obj1_notify, const bool obj2_notify) {
+    if (obj1 == obj2) {
+      // sprites of the same object
+      return;
+    }
+    uint8_t notify = uint8_t((obj1_notify ? 1 : 0) | (obj2_notify ? 2 : 0));
+    if (obj2 < obj1) {
+      // order pair
+      object *const tmp = obj1;
+      obj1 = obj2;
+      obj2 = tmp;
+      notify = uint8_t(((notify & 1) << 1) | (notify >> 1));
+    }
+    pair *p = find_or_add(obj1, obj2, x, y);
+    if (p) {
+      p->notify |= notify;
+    }
+  }
+
+  // adds collision between 'obj' and tiles with attributes 'attrs' at screen
+  // coordinates 'x', 'y'
+  // note. if added during the frame the attributes are combined
+  void add_tiles(object *obj, const tile_attr attrs, const int16_t x,
+                 const int16_t y) {
+    pair *p = find_or_add(obj, nullptr, x, y);
+    if (p) {
+      p->attrs |= attrs;
+      p->notify = 1;
+    }
+  }
+
+  // calls 'on_collision_with(...)' on interested objects that are not dead
+  // and clears the collisions
+  // note. pairs are dispatched ordered by address of 'obj1' then 'obj2' which
+  //       is the order of the objects' slots in 'objects'
+  void dispatch() {
+    std::sort(pairs_, pairs_ + pairs_len_, [](const pair &a, const pair &b) {
+      return a.obj1 != b.obj1 ? uintptr_t(a.obj1) < uintptr_t(b.obj1)
+                              : uintptr_t(a.obj2) < uintptr_t(b.obj2);
+    });
+    for (int i = 0; i < pairs_len_; i++) {
+      pair &p = pairs_[i];
+      if (!p.obj2) {
+        if (!p.obj1->dead &&
+            p.obj1->on_collision_with(nullptr, p.x, p.y, p.attrs)) {
+          p.obj1->dead = true;
+        }
+        table_[p.table_ix] = -1;
+        continue;
+      }
+      if ((p.notify & 1) && !p.obj1->dead &&
+          p.obj1->on_collision_with(p.obj2, p.x, p.y, ta_none)) {
+        p.obj1->dead = true;
+      }
+      if ((p.notify & 2) && !p.obj2->dead &&
+          p.obj2->on_collision_with(p.obj1, p.x, p.y, ta_none)) {
+        p.obj2->dead = true;
+      }
+      table_[p.table_ix] = -1;
+    }
+    pairs_len_ = 0;
+  }
+} static collisions{};
+
+// uniform grid of sprites of objects that may collide, on or off screen,
+// hashed into buckets and rebuilt every frame after 'pre_render()'
+// * pairs with overlapping bounding boxes in the same layer and with matching
+//   'col_bits' and 'col_mask' are reported to 'collisions'
+// * pairs of objects with 'col_mode_pixel' are reported only if the overlap is
+//   not fully on screen where it is detected with pixel precision
+// * pairs where an object has other 'col_mode' are tested with the shapes
+// * queries of objects in an area for game logic during 'update()'
+// note. coordinates are screen coordinates of sprites in current frame
+// note. sprites exceeding 'spatial_hash_entries' cells in a frame are left out
+class spatial_hash final {
+  struct entry {
+    sprite_ix spr;
+    int16_t cell_x;
+    int16_t cell_y;
+    // index of next entry in bucket or -1
+    int16_t next;
+  };
+
+  static constexpr int cell_shift =
+      count_right_shifts_until_1(spatial_hash_cell_size);
+  static_assert((1 << cell_shift) == spatial_hash_cell_size,
+                "spatial_hash_cell_size must be a power of 2");
+  static_assert((spatial_hash_buckets & (spatial_hash_buckets - 1)) == 0,
+                "spatial_hash_buckets must be a power of 2");
+
+  entry entries_[spatial_hash_entries];
+  int entries_len_ = 0;
+  // index of first entry in bucket or -1
+  int16_t buckets_[spatial_hash_buckets];
+  // id of last query that visited sprite to report objects once per query
+  uint16_t visited_[sprites_count]{};
+  uint16_t query_id_ = 0;
+
+  // large primes spreading neighbouring cells over the buckets
+  // note. from "Optimized Spatial Hashing for Collision Detection of
+  //       Deformable Objects" by Teschner et al.
+  static constexpr unsigned cell_x_prime = 73856093u;
+  static constexpr unsigned cell_y_prime = 19349663u;
+
+  static inline auto bucket(const int cell_x, const int cell_y) -> int {
+    return int((unsigned(cell_x) * cell_x_prime) ^
+               (unsigned(cell_y) * cell_y_prime)) &
+           (spatial_hash_buckets - 1);
+  }
+
+  // bounding box of sprite in pixels
+  static inline void bounds(sprite const *spr, int &x, int &y, int &x_end,
+                            int &y_end) {
+    x = spr->scr_x;
+    y = spr->scr_y;
+    x_end = x + spr->w * sprite_width;
+    y_end = y + spr->h * sprite_height;
+  }
+
+  // returns true if circle of 'circle_spr' overlaps bounding box or circle of
+  // 'other_spr' depending on 'col_mode' of its object
+  // note. bounding boxes are known to overlap
+  static auto circle_overlaps(sprite const *circle_spr,
+                              sprite const *other_spr) -> bool {
+    // note. coordinates doubled to keep centers in whole numbers
+    const int w = circle_spr->w * sprite_width;
+    const int h = circle_spr->h * sprite_height;
+    const int cx = 2 * circle_spr->scr_x + w;
+    const int cy = 2 * circle_spr->scr_y + h;
+    const int r = w < h ? w : h;
+    const int other_w = other_spr->w * sprite_width;
+    const int other_h = other_spr->h * sprite_height;
+    if (other_spr->obj->col_mode == col_mode_circle) {
+      const int dx = 2 * other_spr->scr_x + other_w - cx;
+      const int dy = 2 * other_spr->scr_y + other_h - cy;
+      const int r_sum = r + (other_w < other_h ? other_w : other_h);
+      return dx * dx + dy * dy < r_sum * r_sum;
+    }
+    // nearest point in box to center of circle
+    const int x = 2 * other_spr->scr_x;
+    const int y = 2 * other_spr->scr_y;
+    const int nx = cx < x ? x : cx > x + 2 * other_w ? x + 2 * other_w : cx;
+    const int ny = cy < y ? y : cy > y + 2 * other_h ? y + 2 * other_h : cy;
+    const int dx = nx - cx;
+    const int dy = ny - cy;
+    return dx * dx + dy * dy < r * r;
+  }
+
+public:
+  spatial_hash() {
+    for (int i = 0; i < spatial_hash_buckets; i++) {
+      buckets_[i] = -1;
+    }
+  }
+
+  // adds sprites of objects that may collide to the grid
+  void build() {
+    memset(buckets_, 0xff, sizeof(buckets_));
+    entries_len_ = 0;
+    sprite **const end = sprites.allocated_list_end();
+    for (sprite **it = sprites.allocated_list(); it < end; it++) {
+      sprite *spr = *it;
+      if (!spr->img || !spr->obj ||
+          !(spr->obj->col_bits | spr->obj->col_mask)) {
+        continue;
+      }
+      int x = 0, y = 0, x_end = 0, y_end = 0;
+      bounds(spr, x, y, x_end, y_end);
+      const sprite_ix spr_ix = sprite_ix(spr - sprites.all_list());
+      for (int cy = y >> cell_shift; cy <= (y_end - 1) >> cell_shift; cy++) {
+        for (int cx = x >> cell_shift; cx <= (x_end - 1) >> cell_shift;
+             cx++) {
+          if (entries_len_ == spatial_hash_entries) {
+            return;
+          }
+          const int b = bucket(cx, cy);
+          entries_[entries_len_] = {spr_ix, int16_t(cx), int16_t(cy),
+                                    buckets_[b]};
+          buckets_[b] = int16_t(entries_len_);
+          entries_len_++;
+        }
+      }
+    }
+  }
+
+  // adds collisions between overlapping bounding boxes not fully on screen
+  void add_collisions() {
+    for (int b = 0; b < spatial_hash_buckets; b++) {
+      for (int i1 = buckets_[b]; i1 != -1; i1 = entries_[i1].next) {
+        const entry &e1 = entries_[i1];
+        sprite *spr1 = sprites.instance(e1.spr);
+        object *obj1 = spr1->obj;
+        int x1 = 0, y1 = 0, x1_end = 0, y1_end = 0;
+        bounds(spr1, x1, y1, x1_end, y1_end);
+        for (int i2 = e1.next; i2 != -1; i2 = entries_[i2].next) {
+          const entry &e2 = entries_[i2];
+          if (e1.cell_x != e2.cell_x || e1.cell_y != e2.cell_y) {
+            // different cells in same bucket
+            continue;
+          }
+          sprite *spr2 = sprites.instance(e2.spr);
+          object *obj2 = spr2->obj;
+          if (spr1->layer != spr2->layer) {
+            continue;
+          }
+          const bool obj1_col = obj1->col_mask & obj2->col_bits;
+          const bool obj2_col = obj2->col_mask & obj1->col_bits;
+          if (!obj1_col && !obj2_col) {
+            continue;
+          }
+          int x2 = 0, y2 = 0, x2_end = 0, y2_end = 0;
+          bounds(spr2, x2, y2, x2_end, y2_end);
+          // intersection
+          const int x = x1 > x2 ? x1 : x2;
+          const int y = y1 > y2 ? y1 : y2;
+          const int x_end = x1_end < x2_end ? x1_end : x2_end;
+          const int y_end = y1_end < y2_end ? y1_end : y2_end;
+          if (x >= x_end || y >= y_end) {
+            continue;
+          }
+          if ((x >> cell_shift) != e1.cell_x ||
+              (y >> cell_shift) != e1.cell_y) {
+            // report pair only in the cell containing the top left of the
+            // intersection
+            continue;
+          }
+          if (obj1->col_mode == col_mode_pixel &&
+              obj2->col_mode == col_mode_pixel) {
+            if (x >= 0 && y >= 0 && x_end <= display_width &&
+                y_end <= display_height) {
+              // intersection on screen is detected while rendering
+              continue;
+            }
+          } else if (obj1->col_mode == col_mode_circle) {
+            if (!circle_overlaps(spr1, spr2)) {
+              continue;
+            }
+          } else if (obj2->col_mode == col_mode_circle) {
+            if (!circle_overlaps(spr2, spr1)) {
+              continue;
+            }
+          }
+          collisions.add(obj1, obj2, int16_t(x), int16_t(y), obj1_col,
+                         obj2_col);
+        }
+      }
+    }
+  }
+
+  // calls 'func(sprite *)' once for every visible sprite of a live object
+  // that intersects the rectangle where object 'col_bits' bitwise AND 'bits'
+  // is not 0
+  // note. sprite object is 'spr->obj'
+  template <typename Func>
+  void query(const int x, const int y, const int width, const int height,
+             const collision_bits bits, Func func) {
+    query_id_++;
+    if (query_id_ == 0) {
+      // wrapped around
+      memset(visited_, 0, sizeof(visited_));
+      query_id_ = 1;
+    }
+    const int x_end = x + width;
+    const int y_end = y + height;
+    for (int cy = y >> cell_shift; cy <= (y_end - 1) >> cell_shift; cy++) {
+      for (int cx = x >> cell_shift; cx <= (x_end - 1) >> cell_shift; cx++) {
+        for (int i = buckets_[bucket(cx, cy)]; i != -1; i = entries_[i].next) {
+          const entry &e = entries_[i];
+          if (e.cell_x != cx || e.cell_y != cy ||
+              visited_[e.spr] == query_id_) {
+            continue;
+          }
+          visited_[e.spr] = query_id_;
+          sprite *spr = sprites.instance(e.spr);
+          // note. grid is built before collisions are dispatched and objects
+          //       updated; sprites turned off or freed and objects that died
+          //       since are skipped
+          if (!spr->img || spr->obj->dead || !(spr->obj->col_bits & bits)) {
+            continue;
+          }
+          int sx = 0, sy = 0, sx_end = 0, sy_end = 0;
+          bounds(spr, sx, sy, sx_end, sy_end);
+          if (sx < x_end && x < sx_end && sy < y_end && y < sy_end) {
+            func(spr);
+          }
+        }
+      }
+    }
+  }
+
+  // returns live object with visible sprite center nearest to 'x', 'y'
+  // within 'radius' where 'col_bits' bitwise AND 'bits' is not 0 or
+  // 'nullptr' if none
+  // note. 'exclude' is not considered, e.g. the object doing the query
+  auto nearest(const int x, const int y, const int radius,
+               const collision_bits bits, object const *exclude = nullptr)
+      -> object * {
+    object *found = nullptr;
+    int found_dist2 = radius * radius + 1;
+    query(x - radius, y - radius, 2 * radius + 1, 2 * radius + 1, bits,
+          [&](sprite *spr) {
+            if (spr->obj == exclude) {
+              return;
+            }
+            const int dx = spr->scr_x + spr->w * sprite_width / 2 - x;
+            const int dy = spr->scr_y + spr->h * sprite_height / 2 - y;
+            const int dist2 = dx * dx + dy * dy;
+            if (dist2 < found_dist2) {
+              found_dist2 = dist2;
+              found = spr->obj;
+            }
+          });
+    return found;
+  }
+} static spatial_hash{};
+
+// tile map position at previous 'tile_map_collisions()'
+static int tile_col_map_x = 0;
+static int tile_col_map_y = 0;
+
+// adds collisions of sprites of objects with 'col_tile_mask' with tiles on
+// screen
+// note. movement since previous frame is swept so that sprites moving several
+//       pixels per frame do not pass through tiles
+static void tile_map_collisions() {
+  const int map_dx = int(tile_map_x) - tile_col_map_x;
+  const int map_dy = int(tile_map_y) - tile_col_map_y;
+  tile_col_map_x = int(tile_map_x);
+  tile_col_map_y = int(tile_map_y);
+  sprite **const end = sprites.allocated_list_end();
+  for (sprite **it = sprites.allocated_list(); it < end; it++) {
+    sprite *spr = *it;
+    if (!spr->img || !spr->obj || !spr->obj->col_tile_mask) {
+      spr->tile_col_x = tile_col_none;
+      continue;
+    }
+    // previous position in current screen coordinates
+    int x = spr->scr_x;
+    int y = spr->scr_y;
+    if (spr->tile_col_x != tile_col_none) {
+      x = spr->tile_col_x - map_dx;
+      y = spr->tile_col_y - map_dy;
+    }
+    spr->tile_col_x = spr->scr_x;
+    spr->tile_col_y = spr->scr_y;
+    tile_map_hit hit;
+    if (tile_map_sweep(float(x), float(y), spr->w * sprite_width,
+                       spr->h * sprite_height, float(spr->scr_x - x),
+                       float(spr->scr_y - y), spr->obj->col_tile_mask,
+                       hit)) {
+      collisions.add_tiles(spr->obj, hit.attrs, hit.x, hit.y);
+    }
+  }
+}
+
 // helper class managing current frame time, dt, frames per second calculation
 class clk {
 public:
@@ -186,6 +1274,105 @@ public:
 static void engine_setup() {
   // set random seed for deterministic behavior
   srand(random_seed);
+
+  tile_map.set_source(&tile_map_rle_source);
+
+  palette_sprites_copy_banks();
+}
+
+// tile map streamed from the loaded asset pack
+static tile_map_source_file<tile_ix, tile_map_width> tile_map_file_source{};
+
+// loads palettes, tile and sprite images, tile attributes from asset pack at
+// 'path' into heap and streams the tile map from the file
+// returns false if pack could not be loaded, or its tile map is corrupt or
+// refers to tiles not in the pack, in which case resources in program memory
+// are used
+// note. called from platform code after 'engine_setup()'
+// note. a pack is loaded once since the tile map and the prefetch task keep
+//       reading from its file and its resources stay in use, returns false
+//       if a pack is already loaded
+static auto engine_load_asset_pack(const char *path) -> bool {
+  if (tile_map_file_source.is_open()) {
+    printf("!!! asset pack '%s' not loaded, a pack is already loaded\n", path);
+    return false;
+  }
+  asset_pack_reader pack{};
+  if (!pack.open(path)) {
+    printf("!!! asset pack '%s' could not be opened\n", path);
+    return false;
+  }
+  const asset_pack_header &hdr = pack.header;
+  if (hdr.tile_width != tile_width || hdr.tile_height != tile_height ||
+      hdr.sprite_width != sprite_width || hdr.sprite_height != sprite_height ||
+      hdr.tiles_bpp != tiles_bpp || hdr.sprites_bpp != sprites_bpp ||
+      hdr.tiles_count > uint32_t(tiles_count) ||
+      hdr.sprite_imgs_count > uint32_t(sprite_imgs_count) ||
+      hdr.sprite_imgs_ix_count != uint32_t(sprite_imgs_count)) {
+    printf("!!! asset pack '%s' does not match 'defs.hpp'\n", path);
+    pack.close();
+    return false;
+  }
+  uint8_t(*tiles_heap)[tile_img_size_B] =
+      static_cast<uint8_t(*)[tile_img_size_B]>(
+          calloc(hdr.tiles_count, sizeof(tiles_progmem[0])));
+  uint8_t(*sprite_imgs_heap)[sprite_img_size_B] =
+      static_cast<uint8_t(*)[sprite_img_size_B]>(
+          calloc(hdr.sprite_imgs_count, sizeof(sprite_imgs_progmem[0])));
+  sprite_img_ix *sprite_imgs_ix_heap = static_cast<sprite_img_ix *>(
+      calloc(sprite_imgs_count, sizeof(sprite_img_ix)));
+  uint8_t *sprite_imgs_flip_heap =
+      static_cast<uint8_t *>(calloc(sprite_imgs_count, sizeof(uint8_t)));
+  tile_attr *tile_attrs_heap =
+      static_cast<tile_attr *>(calloc(hdr.tiles_count, sizeof(tile_attr)));
+  uint16_t palettes[2][256];
+  uint16_t ix[sprite_imgs_count];
+  static_assert(sprite_imgs_count <= asset_pack_sprite_img_ix_mask + 1,
+                "asset pack image index must fit beside the flip bits");
+  if (!tiles_heap || !sprite_imgs_heap || !sprite_imgs_ix_heap ||
+      !sprite_imgs_flip_heap || !tile_attrs_heap ||
+      !pack.read(hdr.palettes_offset, palettes, sizeof(palettes)) ||
+      !pack.read(hdr.tiles_offset, tiles_heap,
+                 hdr.tiles_count * sizeof(tiles_progmem[0])) ||
+      !pack.read(hdr.sprite_imgs_offset, sprite_imgs_heap,
+                 hdr.sprite_imgs_count * sizeof(sprite_imgs_progmem[0])) ||
+      !pack.read(hdr.sprite_imgs_ix_offset, ix, sizeof(ix)) ||
+      !pack.read(hdr.tile_attrs_offset, tile_attrs_heap,
+                 hdr.tiles_count * sizeof(tile_attr)) ||
+      !tile_map_file_source.open(path, long(hdr.tile_map_offset),
+                                 int(hdr.tiles_count)) ||
+      !tile_map_file_source.validate()) {
+    printf("!!! asset pack '%s' could not be loaded\n", path);
+    tile_map_file_source.close();
+    free(tiles_heap);
+    free(sprite_imgs_heap);
+    free(sprite_imgs_ix_heap);
+    free(sprite_imgs_flip_heap);
+    free(tile_attrs_heap);
+    pack.close();
+    return false;
+  }
+  pack.close();
+
+  for (int i = 0; i < sprite_imgs_count; i++) {
+    // note. index out of range points to first image
+    const uint16_t img_ix = ix[i] & asset_pack_sprite_img_ix_mask;
+    sprite_imgs_ix_heap[i] =
+        img_ix < hdr.sprite_imgs_count ? sprite_img_ix(img_ix) : 0;
+    sprite_imgs_flip_heap[i] = uint8_t(ix[i] >> asset_pack_sprite_flip_shift);
+  }
+
+  memcpy(palette_tiles, palettes[0], sizeof(palette_tiles));
+  tile_scanline_cache.clear();
+  memcpy(palette_sprites[0], palettes[1], sizeof(palette_sprites[0]));
+  palette_sprites_copy_banks();
+  tiles = tiles_heap;
+  tile_attrs = tile_attrs_heap;
+  sprite_imgs.set(sprite_imgs_heap, sprite_imgs_ix_heap,
+                  sprite_imgs_flip_heap, int(hdr.sprite_imgs_count));
+  tile_map.set_source(&tile_map_file_source);
+
+  return true;
 }
 
 // forward declaration of platform specific function
@@ -198,22 +1385,73 @@ static void main_on_frame_completed();
 // render and update the state of the engine
 static void engine_loop() {
   // prepare objects for render
-  objects.pre_render();
+  {
+    profiler_scope prof{prof_pre_render};
+    objects.pre_render();
+  }
+
+  // add sprites that may collide to grid and detect collisions off screen
+  {
+    profiler_scope prof{prof_collisions};
+    spatial_hash.build();
+    if (collisions_enabled) {
+      spatial_hash.add_collisions();
+    }
+  }
+
+  // decode tile map rows scrolled into view
+  {
+    profiler_scope prof{prof_tile_map};
+    tile_map.update(int(tile_map_y) / tile_height, tile_map_visible_rows);
+  }
+
+  // detect collisions of objects with tiles on screen
+  if (collisions_enabled) {
+    profiler_scope prof{prof_collisions};
+    tile_map_collisions();
+  }
+
+  // render tiles, sprites and detect collisions
+  {
+    profiler_scope prof{prof_render};
+    // track changes on screen since previous frame
+    if (partial_frames) {
+      frame_damage.update(int(tile_map_x), int(tile_map_y));
+    }
 
-  // render tiles, sprites and collision map
-  render(int(tile_map_x), int(tile_map_y));
+    render(int(tile_map_x), int(tile_map_y));
+
+    if (partial_frames) {
+      frame_damage.clear();
+    }
+  }
+
+  // call 'on_collision_with(...)' on objects in collision
+  {
+    profiler_scope prof{prof_dispatch};
+    collisions.dispatch();
+  }
 
   // call 'update()' on allocated objects
-  objects.update();
+  {
+    profiler_scope prof{prof_update};
+    objects.update();
+  }
 
-  // deallocate the objects freed during 'objects.update()'
-  objects.apply_free();
+  {
+    profiler_scope prof{prof_apply_free};
+    // deallocate the objects freed during 'objects.update()'
+    objects.apply_free();
 
-  // deallocate the sprites freed during 'objects.update()'
-  sprites.apply_free();
+    // deallocate the sprites freed during 'objects.update()'
+    sprites.apply_free();
+  }
 
   // game logic hook
-  main_on_frame_completed();
+  {
+    profiler_scope prof{prof_frame_completed};
+    main_on_frame_completed();
+  }
 }
 
 // used for static assert of object sizes and config
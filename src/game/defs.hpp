@@ -17,9 +17,38 @@ static constexpr int clk_locked_dt_ms = 32;
 // 0 to update fps every frame and make no output
 static constexpr int clk_fps_update_ms = 2000;
 
-// number of sprite images
+// profile phases of frames and print min, average, 99th percentile and max
+// time of each phase at fps update, see 'profiler.hpp'
+static constexpr bool profiler_enabled = false;
+
+// binary telemetry records written to the serial port instead of the status
+// line at fps update, decoded by 'etc/telemetry-decode.py'
+// note. records are written to a ring buffer of 'telemetry_ring_size_B' bytes
+//       that is written to the serial port by a task on the other core
+// note. see 'telemetry.hpp'
+static constexpr bool telemetry_enabled = false;
+static constexpr int telemetry_ring_size_B = 4096;
+
+// debug overlay composited into scanlines while rendering
+// * bounding boxes of sprites: green if colliding with pixels, cyan if
+//   colliding with bounding shapes, gray if not colliding
+// * pixels where colliding sprites overlap in yellow and where a collision was
+//   reported in red
+// * heat bar of rendering time of each scanline at the right edge, relative
+//   to the slowest scanline of the previous frame
+// * fps and frame time in top left corner
+// note. shown when 'debug_overlay_visible' in 'main.cpp', switched from the
+//       serial console, and forces whole frames
+// note. no code is generated when false
+static constexpr bool debug_overlay = false;
+
+// number of sprite images in 'png-to-resources/sprites.png'
 static constexpr int sprite_imgs_count = 256;
-// defined in 'resources/sprite_imgs.hpp'
+// used images are compiled into 'resources/sprite_imgs.hpp'
+
+// number of sprite images per row in 'png-to-resources/sprites.png'
+// note. used to address regions of images for sprites larger than one cell
+static constexpr int sprite_imgs_per_row = 16;
 
 // type used to index in the 'sprite_imgs' array
 using sprite_img_ix = uint8_t;
@@ -28,6 +57,88 @@ using sprite_img_ix = uint8_t;
 static constexpr int sprite_width = 16;
 static constexpr int sprite_height = 16;
 // note. when changing dimensions update 'png-to-resources/extract.sh'
+// note. a sprite is 'sprite::w' x 'sprite::h' cells of this size
+
+// bits per pixel of sprite images, 8 or 4
+// note. 4 bits per pixel images have a sub-palette of 16 colors per image
+// note. when changing update 'png-to-resources/extract.sh'
+static constexpr int sprites_bpp = 8;
+
+// number of sprite palette banks selected by 'sprite::palette'
+// note. bank 0 is the palette from 'resources/palette_sprites.hpp' and the
+//       other banks are copies of it at start, modified by game code
+// note. each bank is 512 B in DRAM
+static constexpr int sprites_palette_banks = 4;
+
+// sprite palette banks used by game
+// note. set up in 'main_setup()'
+static constexpr uint8_t palette_bank_default = 0;
+static constexpr uint8_t palette_bank_hit = 1;
+
+// collision detection between sprites on screen
+// * pixels: compares pixels of sprites in a scanline buffer while rendering
+// * masks: tests overlapping sprites with bitwise AND of precomputed opacity
+//   masks of image rows, independent of rendering
+// note. masks use 4 B per image row on heap
+enum collision_detector : uint8_t {
+  collision_detector_pixels,
+  collision_detector_masks
+};
+static constexpr collision_detector collision_detection =
+    collision_detector_pixels;
+
+// order in which a scanline is rendered
+// * back to front: tiles then sprites by layer overwriting pixels
+// * front to back: sprites from top layer down, writing only pixels not yet
+//   covered, then tiles in the uncovered gaps; each pixel is written once
+// note. front to back saves palette lookups and stores when sprites cover much
+//       of the screen at the cost of a coverage test per sprite pixel
+// note. collisions detected with pixels are the same in both orders and are
+//       dispatched in the same order
+enum render_order : uint8_t { render_back_to_front, render_front_to_back };
+static constexpr render_order rendering_order = render_back_to_front;
+
+// resolution at which scanlines are rendered before being expanded to the
+// display
+// * pixels doubled: half horizontal resolution, each pixel written twice
+// * lines doubled: half vertical resolution, each line written twice
+// note. initial value of 'rendering_resolution' in 'engine.hpp' that may be
+//       changed at runtime, e.g. during scenes with many sprites
+// note. collisions are detected at the rendered resolution
+enum render_resolution : uint8_t {
+  render_full = 0,
+  render_pixels_doubled = 1,
+  render_lines_doubled = 2,
+  render_pixels_and_lines_doubled = 3
+};
+static constexpr render_resolution render_resolution_default = render_full;
+
+// partial frame updates when the screen is mostly static
+// * only bands of scanlines where sprites or tiles changed since the previous
+//   frame are rendered and transferred, within the horizontal extent of the
+//   changes
+// * whole frame when scrolled or when changes cover more than
+//   'partial_frames_max_percent' of the screen
+// note. collisions are detected on the whole screen regardless
+// note. see 'frame_damage' in 'engine.hpp'
+static constexpr bool partial_frames = true;
+static constexpr int partial_frames_max_percent = 50;
+
+// cache of scanlines rendered from tiles only, copied instead of rendered while
+// the scanline stays on screen
+// * lines are allocated at setup, up to 'tile_scanline_cache_lines' while free
+//   heap stays above 'tile_scanline_cache_heap_reserve_B'
+// * a line of tile map scanline 'y' is cached in slot 'y % lines' unless the
+//   slot holds another line on screen; with lines as many as the display
+//   height every scanline but the ones scrolled in is copied
+// * 64 lines take 30 KB and cache a band of a fifth of the screen, leaving
+//   the heap for game code
+// * cache is cleared when the tile map is scrolled horizontally or rendering
+//   resolution changes
+// note. each line is display width * 2 B, 0 lines disables the cache
+// note. see 'tile_scanline_cache' in 'engine.hpp'
+static constexpr int tile_scanline_cache_lines = 64;
+static constexpr int tile_scanline_cache_heap_reserve_B = 32 * 1024;
 
 // number of layers of sprites
 // note. number of layers deteriorates performance
@@ -35,9 +146,9 @@ static constexpr int sprite_height = 16;
 // 0: ground, 1: air
 static constexpr int sprites_layers = 2;
 
-// number of tile images
+// maximum number of tile images
 static constexpr int tiles_count = 256;
-// defined in 'resources/tiles.hpp'
+// used images are compiled into 'resources/tiles.hpp'
 
 // type used to index in the 'tiles' array from 'tile_map'
 using tile_ix = uint8_t;
@@ -47,6 +158,18 @@ static constexpr int tile_width = 16;
 static constexpr int tile_height = 16;
 // note. when changing dimensions update 'png-to-resources/extract.sh'
 
+// bits per pixel of tile images, 8 or 4
+// note. when changing update 'png-to-resources/extract.sh'
+static constexpr int tiles_bpp = 8;
+
+// attributes of tiles used for collisions between objects and tile map
+// note. set per tile in 'png-to-resources/tile-attributes.txt'
+using tile_attr = uint8_t;
+static constexpr tile_attr ta_none = 0;
+static constexpr tile_attr ta_solid = 1 << 0;
+static constexpr tile_attr ta_damage = 1 << 1;
+static constexpr tile_attr ta_trigger = 1 << 2;
+
 //
 // example configuration for more sprites and tiles
 //
@@ -58,19 +181,39 @@ static constexpr int tile_height = 16;
 // tile map dimension
 static constexpr int tile_map_width = 15;
 static constexpr int tile_map_height = 320;
-// defined in 'resources/tile_map.hpp'
+// defined in 'resources/tile_map.hpp' and compressed into
+// 'resources/tile_map_rle*.hpp' by 'png-to-resources/extract.sh'
+
+// number of tile map rows kept in memory
+// note. rows visible on screen plus a margin of rows that are decoded before
+//       being scrolled into view
+static constexpr int tile_map_rows_buffered = 25;
 
 // type used to index a 'sprite'
-// note. 8-bit for 'collision_map' to fit in a contiguous block on heap
-using sprite_ix = uint8_t;
+// note. 'uint8_t' limits 'sprites_count' to 255
+using sprite_ix = uint16_t;
 
 // sprites available for allocation using 'sprites'
 // note. maximum is one less than limit of type 'sprite_ix' due to the reserved
 //       sprite index (maximum limit) used at collision detection
-static constexpr int sprites_count = 255;
+// note. allocated on heap, see 'setup()' output for sizes
+static constexpr int sprites_count = 1024;
 
 // objects available for allocation using 'objects'
-static constexpr int objects_count = 255;
+// note. each object is 'object_instance_max_size_B' on heap
+static constexpr int objects_count = 512;
+
+// pairs of objects in collision that can be reported during a frame
+// note. power of 2
+static constexpr int collisions_count = 256;
+
+// grid of sprites of objects that may collide used for collisions off screen
+// and queries by game code
+// note. cell size and number of buckets are powers of 2
+// note. each entry is a sprite in a cell
+static constexpr int spatial_hash_cell_size = 32;
+static constexpr int spatial_hash_buckets = 256;
+static constexpr int spatial_hash_entries = 2048;
 
 // used by 'engine.hpp' as seed for random numbers
 static constexpr int random_seed = 0;
@@ -18,6 +18,9 @@
 // then other
 #include "objects/utils.hpp"
 
+// forward declaration of function that sets the first wave trigger
+static void wave_triggers_reset();
+
 // callback from 'setup()'
 static void main_setup() {
   // output size of game object classes
@@ -39,9 +42,17 @@ static void main_setup() {
                        upgrade_picked, upgrade, ufo2>() <=
       object_instance_max_size_B);
 
+  // palette bank used when objects are hit renders all colors white
+  for (int i = 1; i < 256; i++) {
+    palette_sprites[palette_bank_hit][i] = 0xffff;
+  }
+
   // scrolling vertically from bottom up
-  tile_map_y = tile_map_height * tile_height - display_height;
+  // note. tile map height may differ from 'tile_map_height' when loaded from an
+  //       asset pack
+  tile_map_y = float(tile_map.height() * tile_height - display_height);
   tile_map_dy = -16;
+  wave_triggers_reset();
 
   // create default hero
   hero *hro = new (objects.allocate_instance()) hero{};
@@ -106,18 +117,20 @@ struct wave_trigger {
     {y_for_screen_percentage(50), main_wave_4},
 };
 
-// largest tile map y
-static constexpr float wave_triggers_bottom_screen_y =
-    tile_map_height * tile_height - display_height;
-
 static constexpr int wave_triggers_len =
     sizeof(wave_triggers) / sizeof(wave_trigger);
 
 static int wave_triggers_ix = 0;
 
-// initiate to when the first wave is triggered
-static float wave_triggers_next_y =
-    wave_triggers_bottom_screen_y - wave_triggers[0].since_last_wave_y;
+static float wave_triggers_next_y = 0;
+
+// sets y of first wave trigger relative to largest tile map y
+static void wave_triggers_reset() {
+  wave_triggers_ix = 0;
+  wave_triggers_next_y = float(tile_map.height() * tile_height -
+                               display_height) -
+                         wave_triggers[0].since_last_wave_y;
+}
 
 // callback after frame has been rendered and objects updated
 // note. if objects are deleted see objects::update()
@@ -136,13 +149,10 @@ static void main_on_frame_completed() {
   if (tile_map_y < 0) {
     tile_map_y = 0;
     tile_map_dy = -tile_map_dy;
-  } else if (tile_map_y > (tile_map_height * tile_height - display_height)) {
-    tile_map_y = tile_map_height * tile_height - display_height;
+  } else if (tile_map_y > (tile_map.height() * tile_height - display_height)) {
+    tile_map_y = float(tile_map.height() * tile_height - display_height);
     tile_map_dy = -tile_map_dy;
-    // set y of first wave trigger
-    wave_triggers_ix = 0;
-    wave_triggers_next_y =
-        wave_triggers_bottom_screen_y - wave_triggers[0].since_last_wave_y;
+    wave_triggers_reset();
   }
 
   if (!game_state.hero_is_alive) {
@@ -31,17 +31,21 @@ public:
     sprites.free_instance(spr);
   }
 
+  // called by engine for every object in collision during the frame and
+  // with 'obj' 'nullptr' for collision with tiles matching 'col_tile_mask'
   // returns true if object has died
-  // note. regarding classes overriding 'update(...)'
-  // after 'update(...)' 'col_with' should be 'nullptr'
-  auto update() -> bool override {
-    if (col_with) {
-      if (on_collision(static_cast<game_object *>(col_with))) {
-        return true;
-      }
-      col_with = nullptr;
+  // note. point of contact is not used by the game objects
+  auto on_collision_with(object *obj, int16_t, int16_t, tile_attr)
+      -> bool override {
+    if (!obj) {
+      // note. game objects do not declare 'col_tile_mask'
+      return false;
     }
+    return on_collision(static_cast<game_object *>(obj));
+  }
 
+  // returns true if object has died
+  auto update() -> bool override {
     dx += ddx * clk.dt;
     x += dx * clk.dt;
     dy += ddy * clk.dt;
@@ -56,7 +60,7 @@ public:
     spr->scr_y = int16_t(y);
   }
 
-  // called from 'update' if object is in collision
+  // called from 'on_collision_with' once for every object in collision
   // returns true if object has died
   virtual auto on_collision(game_object *obj) -> bool {
     health = int16_t(health - obj->damage);
@@ -12,8 +12,8 @@
 #include "utils.hpp"
 
 class hero final : public game_object {
-  sprite *spr_left = nullptr;
-  sprite *spr_right = nullptr;
+  // images of the 3 x 1 cells of the sprite
+  uint8_t const *imgs[3];
   clk::time last_upgrade_deployed_ms = 0;
   static constexpr clk::time upgrade_deploy_interval_ms = 10000;
 
@@ -24,38 +24,21 @@ public:
 
     health = 10;
 
+    imgs[0] = imgs[1] = imgs[2] = sprite_imgs[0];
+
     spr = sprites.allocate_instance();
     spr->obj = this;
-    spr->img = sprite_imgs[0];
+    spr->img = imgs[0];
+    spr->imgs = imgs;
+    spr->w = 3;
     spr->layer = 1; // put in top layer
-    spr->flip = 0;
-
-    spr_left = sprites.allocate_instance();
-    spr_left->obj = this;
-    spr_left->img = sprite_imgs[0];
-    spr_left->layer = 1;
-    spr_left->flip = 0;
-
-    spr_right = sprites.allocate_instance();
-    spr_right->obj = this;
-    spr_right->img = sprite_imgs[0];
-    spr_right->layer = 1;
-    spr_right->flip = 0;
 
     last_upgrade_deployed_ms = clk.ms;
 
     game_state.hero_is_alive = true;
   }
 
-  ~hero() override {
-    // turn off and free sprites
-    spr_left->img = nullptr;
-    sprites.free_instance(spr_left);
-    spr_right->img = nullptr;
-    sprites.free_instance(spr_right);
-
-    game_state.hero_is_alive = false;
-  }
+  ~hero() override { game_state.hero_is_alive = false; }
 
   // returns true if object died
   auto update() -> bool override {
@@ -88,12 +71,8 @@ public:
   void pre_render() override {
     game_object::pre_render();
 
-    // set position of additional sprites
-    spr_left->scr_x = int16_t(spr->scr_x - sprite_width);
-    spr_left->scr_y = spr->scr_y;
-
-    spr_right->scr_x = int16_t(spr->scr_x + sprite_width);
-    spr_right->scr_y = spr->scr_y;
+    // position is at the middle cell
+    spr->scr_x = int16_t(spr->scr_x - sprite_width);
   }
 
 private:
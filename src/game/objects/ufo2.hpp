@@ -8,17 +8,35 @@
 #include "utils.hpp"
 
 class ufo2 final : public game_object {
-  sprites_2x2 sprs;
+  // images of the 2 x 2 cells of the sprite
+  uint8_t const *imgs[4];
+  // time when hit flash ends or 0 if not flashing
+  clk::time hit_flash_end_ms = 0;
+  static constexpr clk::time hit_flash_ms = 64;
 
 public:
-  ufo2() : game_object{ufo2_cls}, sprs{this, 10, 1} {
+  ufo2() : game_object{ufo2_cls} {
     col_bits = cb_hero;
     col_mask = cb_enemy | cb_enemy_bullet;
+    col_mode = col_mode_circle;
 
     health = 100;
+
+    spr = sprites.allocate_instance();
+    spr->obj = this;
+    sprite_imgs.region(10, 2, 2, imgs);
+    spr->imgs = imgs;
+    spr->img = imgs[0];
+    spr->w = 2;
+    spr->h = 2;
+    spr->layer = 1;
   }
 
-  void pre_render() override { sprs.pre_render(this); }
+  // position is center of sprite
+  void pre_render() override {
+    spr->scr_x = int16_t(x - sprite_width);
+    spr->scr_y = int16_t(y - sprite_height);
+  }
 
   auto update() -> bool override {
     if (game_object::update()) {
@@ -27,10 +45,17 @@ public:
     if (y > (display_height + sprite_height)) {
       return true;
     }
+    if (hit_flash_end_ms && clk.ms >= hit_flash_end_ms) {
+      hit_flash_end_ms = 0;
+      spr->palette = palette_bank_default;
+    }
     return false;
   }
 
   auto on_collision(game_object *obj) -> bool override {
+    hit_flash_end_ms = clk.ms + hit_flash_ms;
+    spr->palette = palette_bank_hit;
+
     ship2 *shp = new (objects.allocate_instance()) ship2{};
     shp->x = obj->x;
     shp->y = obj->y - sprite_height;
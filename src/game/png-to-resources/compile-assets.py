@@ -0,0 +1,300 @@
+#!/bin/python3
+import glob
+import re
+import sys
+
+# compiles images extracted by 'read-sprites.py' into the resources used by
+# the engine
+#
+# * tiles not referenced by the tile map are dropped
+# * sprites not referenced by game code are dropped
+# * identical images are stored once
+# * sprites that are flipped copies of other sprites are stored once with a
+#   flip attribute
+# * tile map is written with indexes into the compacted tiles
+# * tables mapping index in 'sprites.png' to index of compacted image and to
+#   flip applied to it, bit 0 horizontal and bit 1 vertical as 'sprite::flip'
+# * images are written with 8 or 4 bits per pixel
+# * attributes of compacted tiles from 'tile attributes' file where tiles with
+#   identical images but different attributes are stored separately
+#
+# 4 bits per pixel image format:
+# * 16 bytes sub-palette with indexes in the palette
+# * 2 pixels per byte, low nibble first, with index in the sub-palette
+#
+# sprites are referenced in game code by:
+# * 'sprite_imgs[<number>]'
+# * 'sprite_imgs[<array>[...]]' where '<array>' is initialized in game code as
+#   'sprite_img_ix <array>[] = {<numbers>}'
+# * 'sprite_imgs.region(<number>, <width>, <height>, ...)'
+# any other reference to 'sprite_imgs' is an error since the images it uses
+# cannot be known
+#
+# note. tiles that are flipped copies of other tiles are reported but kept
+#       since the tile map does not carry flip bits
+
+
+def read_images(filename: str) -> list[list[int]]:
+    images = []
+    with open(filename) as f:
+        for line in f:
+            line = line.split("//")[0].strip()
+            if line.startswith("{"):
+                images.append([])
+            elif line.startswith("}"):
+                continue
+            else:
+                images[-1] += [int(v, 0) for v in re.findall(r"0x[0-9a-fA-F]+", line)]
+    return images
+
+
+def read_tile_map(filename: str) -> list[list[int]]:
+    rows = []
+    with open(filename) as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith("{"):
+                rows.append([int(v, 0) for v in re.findall(r"0x[0-9a-fA-F]+|\d+", line)])
+    return rows
+
+
+def read_tile_attributes(filename: str, count: int) -> list[int]:
+    # lines of '<index in tiles.png> <attributes>', '#' starts a comment
+    attrs = [0] * count
+    with open(filename) as f:
+        for line in f:
+            line = line.split("#")[0].split()
+            if line:
+                attrs[int(line[0], 0)] = int(line[1], 0)
+    return attrs
+
+
+def read_constant(filename: str, name: str) -> int:
+    with open(filename) as f:
+        match = re.search(name + r"\s*=\s*(\d+)\s*;", f.read())
+    if not match:
+        print(f"Error: '{name}' not found in {filename}")
+        sys.exit(1)
+    return int(match.group(1))
+
+
+def sprites_referenced_by_game_code(game_dir: str, count: int) -> set[int]:
+    per_row = read_constant(game_dir + "/defs.hpp", "sprite_imgs_per_row")
+    files = sorted(glob.glob(game_dir + "/*.hpp") + glob.glob(game_dir + "/objects/*.hpp"))
+    sources = {}
+    for filename in files:
+        with open(filename) as f:
+            # note. line comments are removed
+            sources[filename] = [line.split("//")[0] for line in f]
+
+    # arrays of sprite indexes such as animation frames
+    arrays = {}
+    for lines in sources.values():
+        text = "".join(lines)
+        for name, values in re.findall(
+            r"sprite_img_ix\s+(?:\w+::)?(\w+)\s*\[\s*\]\s*=\s*\{([^}]*)\}", text
+        ):
+            arrays[name] = [int(v, 0) for v in re.findall(r"0x[0-9a-fA-F]+|\d+", values)]
+
+    used = set()
+    errors = 0
+    for filename, lines in sources.items():
+        for line_no, line in enumerate(lines, 1):
+            for ref in re.finditer(r"sprite_imgs\s*(\[|\.\s*region\s*\()", line):
+                rest = line[ref.end() :]
+                if ref.group(1) == "[":
+                    literal = re.match(r"\s*(\d+)\s*\]", rest)
+                    array = re.match(r"\s*(\w+)\s*\[", rest)
+                    if literal:
+                        used.add(int(literal.group(1)))
+                        continue
+                    if array and array.group(1) in arrays:
+                        used |= set(arrays[array.group(1)])
+                        continue
+                else:
+                    region = re.match(r"\s*(\d+)\s*,\s*(\d+)\s*,\s*(\d+)\s*,", rest)
+                    if region:
+                        ix, w, h = (int(v) for v in region.groups())
+                        used |= {ix + y * per_row + x for y in range(h) for x in range(w)}
+                        continue
+                print(
+                    f"Error: {filename}:{line_no}: sprite index cannot be resolved:"
+                    f" {line.strip()}"
+                )
+                errors += 1
+
+    for ix in sorted(used):
+        if ix >= count:
+            print(f"Error: sprite {ix} referenced in game code is not in sprites.png")
+            errors += 1
+    if errors:
+        sys.exit(1)
+    return used
+
+
+def flipped(img: list[int], size: int, horiz: bool, vert: bool) -> tuple:
+    rows = [img[i : i + size] for i in range(0, len(img), size)]
+    if horiz:
+        rows = [row[::-1] for row in rows]
+    if vert:
+        rows = rows[::-1]
+    return tuple(v for row in rows for v in row)
+
+
+def compact(
+    images: list[list[int]], used: list[int], name: str, attrs: list[int], merge_flips: bool
+):
+    # returns list of unique images and map from index to unique image and flip
+    # applied to it, bit 0 horizontal and bit 1 vertical
+    # note. images with different attributes are not identical
+    # note. flipped copies are reported if not merged
+    size = int(len(images[0]) ** 0.5)
+    unique = []
+    unique_ix = {}
+    ix_map = {}
+    for ix in used:
+        img = (tuple(images[ix]), attrs[ix])
+        if img in unique_ix:
+            ix_map[ix] = (unique_ix[img], 0)
+            continue
+        flip = 0
+        for h, v in ((True, False), (False, True), (True, True)):
+            other = unique_ix.get((flipped(images[ix], size, h, v), attrs[ix]))
+            if other is None:
+                continue
+            if merge_flips:
+                flip = (1 if h else 0) | (2 if v else 0)
+                ix_map[ix] = (other, flip)
+                break
+            print(
+                f"note: {name} {ix} is flipped copy of {name}"
+                f" {unique[other][0]} (horiz: {h}, vert: {v})",
+                file=sys.stderr,
+            )
+        if flip:
+            continue
+        unique_ix[img] = len(unique)
+        unique.append((ix, img[0]))
+        ix_map[ix] = (unique_ix[img], 0)
+    return unique, ix_map
+
+
+def write_images(filename: str, unique: list, source: str, count: int, bpp: int):
+    size = int(len(unique[0][1]) ** 0.5)
+    with open(filename, "w") as f:
+        for i, (ix, img) in enumerate(unique):
+            origin = f"{source} {ix}" if ix < count else "transparent"
+            print(f"{{ // {i} ({origin})", file=f)
+            if bpp == 4:
+                colors = sorted(set(img))
+                if len(colors) > 16:
+                    print(f"Error: {origin} has more than 16 colors")
+                    sys.exit(1)
+                sub_palette = colors + [0] * (16 - len(colors))
+                print("".join(f"0x{v:02X}," for v in sub_palette), file=f)
+                packed = [colors.index(v) for v in img]
+                packed = [packed[j] | (packed[j + 1] << 4) for j in range(0, len(packed), 2)]
+                row_len = size // 2
+            else:
+                packed = img
+                row_len = size
+            for y in range(size):
+                print(
+                    "".join(f"0x{v:02X}," for v in packed[y * row_len : (y + 1) * row_len]),
+                    file=f,
+                )
+            print("},", file=f)
+
+
+def compile_assets(
+    tiles_file: str,
+    sprites_file: str,
+    tile_map_file: str,
+    game_dir: str,
+    resources_dir: str,
+    tile_map_output: str,
+    tiles_bpp: int,
+    sprites_bpp: int,
+    tile_attributes_file: str,
+):
+    tiles = read_images(tiles_file)
+    tile_attrs = read_tile_attributes(tile_attributes_file, len(tiles))
+    sprites = read_images(sprites_file)
+    tile_map = read_tile_map(tile_map_file)
+
+    # tiles
+    tiles_used = sorted({ix for row in tile_map for ix in row})
+    tiles_unique, tiles_map = compact(tiles, tiles_used, "tile", tile_attrs, False)
+    write_images(
+        resources_dir + "/tiles.hpp", tiles_unique, "tiles.png", len(tiles), tiles_bpp
+    )
+    with open(resources_dir + "/tile_attrs.hpp", "w") as f:
+        print("// clang-format off", file=f)
+        print(",".join(str(tile_attrs[ix]) for ix, _ in tiles_unique) + ",", file=f)
+        print("// clang-format on", file=f)
+    with open(tile_map_output, "w") as f:
+        print("// clang-format off", file=f)
+        for row in tile_map:
+            print("{" + ",".join(str(tiles_map[ix][0]) for ix in row) + "},", file=f)
+        print("// clang-format on", file=f)
+
+    # sprites
+    sprites_count = len(sprites)
+    sprites_used = sorted(sprites_referenced_by_game_code(game_dir, sprites_count))
+    # unreferenced indexes map to a transparent image
+    blank_ix = 0
+    if len(sprites_used) < sprites_count:
+        sprites = sprites + [[0] * len(sprites[0])]
+        sprites_used.append(sprites_count)
+    sprites_unique, sprites_map = compact(
+        sprites, sprites_used, "sprite", [0] * len(sprites), True
+    )
+    if sprites_count in sprites_map:
+        blank_ix = sprites_map[sprites_count][0]
+    write_images(
+        resources_dir + "/sprite_imgs.hpp",
+        sprites_unique,
+        "sprites.png",
+        sprites_count,
+        sprites_bpp,
+    )
+    with open(resources_dir + "/sprite_imgs_ix.hpp", "w") as f:
+        print("// clang-format off", file=f)
+        ix = [sprites_map.get(i, (blank_ix, 0))[0] for i in range(sprites_count)]
+        for i in range(0, len(ix), 16):
+            print(",".join(str(v) for v in ix[i : i + 16]) + ",", file=f)
+        print("// clang-format on", file=f)
+    with open(resources_dir + "/sprite_imgs_flip.hpp", "w") as f:
+        print("// clang-format off", file=f)
+        flips = [sprites_map.get(i, (0, 0))[1] for i in range(sprites_count)]
+        for i in range(0, len(flips), 16):
+            print(",".join(str(v) for v in flips[i : i + 16]) + ",", file=f)
+        print("// clang-format on", file=f)
+
+    print(
+        f"tiles: {len(tiles_unique)} of {len(tiles)}"
+        f"  sprites: {len(sprites_unique)} of {sprites_count}"
+        f" ({sum(1 for _, flip in sprites_map.values() if flip)} flipped)",
+        file=sys.stderr,
+    )
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 10:
+        print(
+            "usage: compile-assets <tiles> <sprites> <tile map> <game directory>"
+            " <resources directory> <tile map output> <tiles bpp> <sprites bpp>"
+            " <tile attributes>"
+        )
+        sys.exit(1)
+    compile_assets(
+        sys.argv[1],
+        sys.argv[2],
+        sys.argv[3],
+        sys.argv[4],
+        sys.argv[5],
+        sys.argv[6],
+        int(sys.argv[7]),
+        int(sys.argv[8]),
+        sys.argv[9],
+    )
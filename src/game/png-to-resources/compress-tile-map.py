@@ -0,0 +1,96 @@
+#!/bin/python3
+import re
+import struct
+import sys
+
+# compresses the tile map with run-length encoding one row at a time
+#
+# each row is encoded as pairs of {count, tile index} and offsets to the
+# start of each row are emitted so that any row can be decoded independently
+#
+# output:
+#   <prefix>.hpp       encoded rows, partial file included by 'engine.hpp'
+#   <prefix>_rows.hpp  offsets of rows plus end offset
+#   <prefix>.bin       optional binary file (see 'tile_map_stream.hpp')
+
+
+def read_tile_map(filename: str) -> list[list[int]]:
+    rows = []
+    with open(filename) as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith("{"):
+                continue
+            rows.append([int(v, 0) for v in re.findall(r"0x[0-9a-fA-F]+|\d+", line)])
+    return rows
+
+
+def encode_row(row: list[int], max_count: int) -> list[int]:
+    encoded = []
+    i = 0
+    while i < len(row):
+        tile = row[i]
+        count = 1
+        while i + count < len(row) and row[i + count] == tile and count < max_count:
+            count += 1
+        encoded += [count, tile]
+        i += count
+    return encoded
+
+
+def print_values(values: list[int], per_line: int, file):
+    print("// clang-format off", file=file)
+    for i in range(0, len(values), per_line):
+        print(",".join(str(v) for v in values[i : i + per_line]) + ",", file=file)
+    print("// clang-format on", file=file)
+
+
+def compress_tile_map(tile_ix_bits: int, filename: str, prefix: str, binary: bool):
+    rows = read_tile_map(filename)
+    if not rows:
+        print("Error: no rows in tile map")
+        sys.exit(1)
+
+    width = len(rows[0])
+    max_count = (1 << tile_ix_bits) - 1
+    data = []
+    offsets = []
+    for row in rows:
+        if len(row) != width:
+            print("Error: rows of different width")
+            sys.exit(1)
+        offsets.append(len(data))
+        data += encode_row(row, max_count)
+    offsets.append(len(data))
+
+    with open(prefix + ".hpp", "w") as f:
+        print_values(data, 32, f)
+
+    with open(prefix + "_rows.hpp", "w") as f:
+        print_values(offsets, 16, f)
+
+    if binary:
+        # header: width, height, offsets of rows plus end offset, encoded rows
+        # note. little endian
+        fmt = "<B" if tile_ix_bits == 8 else "<H"
+        with open(prefix + ".bin", "wb") as f:
+            f.write(struct.pack("<II", width, len(rows)))
+            for offset in offsets:
+                f.write(struct.pack("<I", offset))
+            for value in data:
+                f.write(struct.pack(fmt, value))
+
+    print(
+        f"tile map {width} x {len(rows)}: {width * len(rows)} tiles"
+        f" encoded into {len(data)} + {len(offsets)} offsets",
+        file=sys.stderr,
+    )
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 4:
+        print("usage: compress-tile-map <tile_ix bits> <tile map> <output prefix> [bin]")
+        sys.exit(1)
+    compress_tile_map(
+        int(sys.argv[1]), sys.argv[2], sys.argv[3], len(sys.argv) > 4 and sys.argv[4] == "bin"
+    )
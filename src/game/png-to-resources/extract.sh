@@ -4,8 +4,21 @@ cd $(dirname "$0")
 
 SIZE=16
 
+# bits per pixel of tiles and sprites, 8 or 4
+# note. must match 'tiles_bpp' and 'sprites_bpp' in 'defs.hpp'
+TILES_BPP=8
+SPRITES_BPP=8
+
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
 ./read-palette.py sprites.png > ../resources/palette_sprites.hpp
-./read-sprites.py $SIZE $SIZE sprites.png > ../resources/sprite_imgs.hpp
+./read-sprites.py $SIZE $SIZE sprites.png > $TMP/sprite_imgs.hpp
 
 ./read-palette.py tiles.png > ../resources/palette_tiles.hpp
-./read-sprites.py $SIZE $SIZE tiles.png > ../resources/tiles.hpp
\ No newline at end of file
+./read-sprites.py $SIZE $SIZE tiles.png > $TMP/tiles.hpp
+
+./compile-assets.py $TMP/tiles.hpp $TMP/sprite_imgs.hpp ../resources/tile_map.hpp \
+    .. ../resources $TMP/tile_map.hpp $TILES_BPP $SPRITES_BPP tile-attributes.txt
+
+./compress-tile-map.py 8 $TMP/tile_map.hpp ../resources/tile_map_rle
@@ -0,0 +1,129 @@
+#!/bin/python3
+import re
+import struct
+import sys
+
+# creates an asset pack (see 'asset_pack.hpp') from the files in 'resources'
+# generated by 'extract.sh'
+#
+# usage: make-asset-pack <tile_ix bits> <size> <tiles bpp> <sprites bpp>
+#                        <resources directory> <output file>
+
+
+def read_values(filename: str) -> list[int]:
+    values = []
+    with open(filename) as f:
+        for line in f:
+            line = line.split("//")[0]
+            values += [int(v, 0) for v in re.findall(r"0x[0-9a-fA-F]+|\d+", line)]
+    return values
+
+
+def read_images(filename: str) -> list[list[int]]:
+    images = []
+    with open(filename) as f:
+        for line in f:
+            line = line.split("//")[0].strip()
+            if line.startswith("{"):
+                images.append([])
+            elif line.startswith("}"):
+                continue
+            images[-1] += [int(v, 0) for v in re.findall(r"0x[0-9a-fA-F]+", line)]
+    return images
+
+
+def encode_tile_map(data: list[int], offsets: list[int], tile_ix_bits: int) -> bytes:
+    # same format as 'compress-tile-map.py' binary output
+    fmt = "<B" if tile_ix_bits == 8 else "<H"
+    width = sum(data[offsets[0] : offsets[1] : 2])
+    out = struct.pack("<II", width, len(offsets) - 1)
+    out += b"".join(struct.pack("<I", o) for o in offsets)
+    out += b"".join(struct.pack(fmt, v) for v in data)
+    return out
+
+
+def make_asset_pack(
+    tile_ix_bits: int, size: int, tiles_bpp: int, sprites_bpp: int, resources: str, output: str
+):
+    palette_tiles = read_values(resources + "/palette_tiles.hpp")
+    palette_sprites = read_values(resources + "/palette_sprites.hpp")
+    tiles = read_images(resources + "/tiles.hpp")
+    sprite_imgs = read_images(resources + "/sprite_imgs.hpp")
+    sprite_imgs_ix = read_values(resources + "/sprite_imgs_ix.hpp")
+    sprite_imgs_flip = read_values(resources + "/sprite_imgs_flip.hpp")
+    tile_map_rle = read_values(resources + "/tile_map_rle.hpp")
+    tile_map_rle_rows = read_values(resources + "/tile_map_rle_rows.hpp")
+    tile_attrs = read_values(resources + "/tile_attrs.hpp")
+
+    # palettes are padded to 256 entries
+    palettes = b""
+    for palette in (palette_tiles, palette_sprites):
+        palette = palette + [0] * (256 - len(palette))
+        palettes += b"".join(struct.pack("<H", v) for v in palette)
+
+    tiles_data = bytes(v for img in tiles for v in img)
+    sprite_imgs_data = bytes(v for img in sprite_imgs for v in img)
+    # flip of image in the 2 highest bits, see 'asset_pack_sprite_flip_shift'
+    sprite_imgs_ix_data = b"".join(
+        struct.pack("<H", ix | flip << 14)
+        for ix, flip in zip(sprite_imgs_ix, sprite_imgs_flip)
+    )
+    tile_map_data = encode_tile_map(tile_map_rle, tile_map_rle_rows, tile_ix_bits)
+    tile_attrs_data = bytes(tile_attrs)
+
+    header_fmt = "<4sIHHHHHHIIIIIIIII"
+    palettes_offset = struct.calcsize(header_fmt)
+    tiles_offset = palettes_offset + len(palettes)
+    sprite_imgs_offset = tiles_offset + len(tiles_data)
+    sprite_imgs_ix_offset = sprite_imgs_offset + len(sprite_imgs_data)
+    tile_map_offset = sprite_imgs_ix_offset + len(sprite_imgs_ix_data)
+    tile_attrs_offset = tile_map_offset + len(tile_map_data)
+
+    header = struct.pack(
+        header_fmt,
+        b"BAMP",
+        5,
+        size,
+        size,
+        size,
+        size,
+        tiles_bpp,
+        sprites_bpp,
+        len(tiles),
+        len(sprite_imgs),
+        len(sprite_imgs_ix),
+        palettes_offset,
+        tiles_offset,
+        sprite_imgs_offset,
+        sprite_imgs_ix_offset,
+        tile_map_offset,
+        tile_attrs_offset,
+    )
+
+    with open(output, "wb") as f:
+        f.write(
+            header
+            + palettes
+            + tiles_data
+            + sprite_imgs_data
+            + sprite_imgs_ix_data
+            + tile_map_data
+            + tile_attrs_data
+        )
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 7:
+        print(
+            "usage: make-asset-pack <tile_ix bits> <size> <tiles bpp> <sprites bpp>"
+            " <resources directory> <output file>"
+        )
+        sys.exit(1)
+    make_asset_pack(
+        int(sys.argv[1]),
+        int(sys.argv[2]),
+        int(sys.argv[3]),
+        int(sys.argv[4]),
+        sys.argv[5],
+        sys.argv[6],
+    )
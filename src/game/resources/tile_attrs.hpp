@@ -0,0 +1,3 @@
+// clang-format off
+0,0,0,
+// clang-format on
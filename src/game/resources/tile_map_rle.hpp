@@ -0,0 +1,30 @@
+// clang-format off
+15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,
+15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,
+15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,
+15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,
+15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,
+15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,
+15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,
+15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,
+15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,
+15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,
+15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,
+15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,
+15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,
+15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,
+15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,
+15,2,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,1,15,2,15,1,15,1,15,1,15,1,15,1,
+15,1,15,1,15,1,15,1,2,1,1,2,2,1,3,2,7,1,1,1,1,2,1,1,1,2,2,1,2,2,7,1,
+2,1,1,2,3,1,2,2,7,1,15,1,3,1,1,2,3,1,1,2,7,1,3,1,1,2,3,1,1,2,7,1,
+2,1,1,2,3,1,1,2,8,1,15,1,3,1,1,2,2,1,1,2,8,1,3,1,1,2,2,1,1,2,8,1,
+2,1,1,2,4,1,1,2,7,1,15,1,1,1,1,2,1,1,1,2,2,1,1,2,8,1,1,1,3,2,1,1,
+1,2,1,1,1,2,7,1,1,1,3,2,2,1,1,2,8,1,15,1,2,1,2,2,1,1,3,2,7,1,2,1,
+1,2,3,1,2,2,7,1,1,1,3,2,1,1,2,2,8,1,15,1,1,0,13,2,1,0,15,1,15,1,15,1,
+15,1,15,1,15,1,15,1,15,1,15,1,1,0,13,2,1,0,15,1,15,1,15,1,15,1,2,1,1,2,3,1,
+3,2,1,1,1,2,4,1,2,1,3,2,1,1,2,2,2,1,1,2,4,1,2,1,1,2,1,1,1,2,1,1,
+3,2,1,1,3,2,2,1,15,1,15,1,1,0,13,2,1,0,15,1,15,1,2,1,1,2,4,1,1,2,7,1,
+2,1,3,2,1,1,1,2,1,1,1,2,1,1,3,2,2,1,2,1,3,2,1,1,1,2,1,1,1,2,1,1,
+3,2,2,1,15,1,15,1,15,1,15,1,1,0,13,2,1,0,15,1,15,1,15,1,15,1,15,1,15,1,15,1,
+15,1,15,1,
+// clang-format on
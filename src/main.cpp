@@ -37,10 +37,14 @@
 #include "game/main.hpp"
 
 // platform specific definitions and objects
+#include <LittleFS.h>
 #include <SPI.h>
 #include <TFT_eSPI.h>
 #include <XPT2046_Touchscreen.h>
 
+#include "console.hpp"
+#include "telemetry.hpp"
+
 static TFT_eSPI display{};
 
 // setup touch screen
@@ -48,29 +52,204 @@ static TFT_eSPI display{};
 static SPIClass hspi{HSPI}; // note. VSPI is used by the display
 static XPT2046_Touchscreen touch_screen{XPT2046_CS, XPT2046_IRQ};
 
+// asset pack uploaded to the file system partition with
+// 'pio run -t uploadfs' from directory 'data'
+// note. path relative to the mounted file system
+static constexpr char const *asset_pack_file = "/assets.bam";
+static constexpr char const *asset_pack_path = "/littlefs/assets.bam";
+
+// maximum number of scanlines to render before DMA transfer
+static constexpr int dma_n_scanlines_max = 16;
 // number of scanlines to render before DMA transfer
-static constexpr int dma_n_scanlines = 8;
+// note. may be changed from the serial console to an even number up to
+//       'dma_n_scanlines_max'
+static int dma_n_scanlines = 8;
 // note. performance on device:
 //  1: 23 fps, 2: 27 fps, 4: 29 fps, 8: 31 fps, 16: 31 fps, 32: 32 fps
 
-// alternating buffers for rendering scanlines while DMA is active
+// ring of buffers for rendering scanlines while DMA transfers queued buffers
+// note. rendering a band of sprite heavy scanlines while the other buffers
+//       are transferred absorbs jitter that would otherwise stall rendering
 // allocated in 'setup()'
+static constexpr int dma_buf_count = 4;
 static constexpr int dma_buf_size_B =
-    sizeof(uint16_t) * display_width * dma_n_scanlines;
-static uint16_t *dma_buf_1 = nullptr;
-static uint16_t *dma_buf_2 = nullptr;
+    sizeof(uint16_t) * display_width * dma_n_scanlines_max;
+static uint16_t *dma_bufs[dma_buf_count];
+// number of buffers of the ring in use
+// note. may be changed from the serial console to at least 2
+static int dma_bufs_used = dma_buf_count;
+// index in 'dma_bufs' of next buffer to render
+static int dma_buf_ix = 0;
+
+static_assert(dma_buf_count - 1 <= TFT_DMA_QUEUE_SIZE,
+              "TFT_DMA_QUEUE_SIZE must fit all buffers but one");
+
+// number of bands of 'damage_band_height' on screen
+// note. partial frames are rendered only when 'dma_n_scanlines' is
+//       'damage_band_height'
+static constexpr int dma_n_bands =
+    (display_height + damage_band_height - 1) / damage_band_height;
+
+static_assert(damage_band_height <= dma_n_scanlines_max,
+              "partial frames transfer bands of 'frame_damage'");
+
+// horizontal extent of the display window in partial frames
+static int display_window_x = 0;
+static int display_window_x_end = display_width;
+// true if the display window is the whole screen and the previous frame was
+// transferred whole, leaving the write position at the top of the screen
+static bool display_window_full = true;
 
 // pixel precision collision detection between on screen sprites
+// note. index of sprite that wrote each pixel in the current scanline since
+//       sprites can only overlap other sprites on the same scanline
+static sprite_ix collision_row[display_width];
+
+// shift from rendered to screen x and number of pixels rendered per scanline
+// set every frame in 'render(...)' from 'rendering_resolution'
+static int render_x_shift = 0;
+static int render_width = display_width;
+
+static_assert(display_width % 2 == 0 && dma_n_scanlines_max % 2 == 0,
+              "doubling pixels and lines requires even width and buffer");
+
+// rendered pixels of the current scanline written by sprites when
+// 'rendering_order' is front to back; bit 'x & 31' of word 'x >> 5' is pixel
+// 'x'
+static constexpr int render_coverage_len = (display_width + 31) / 32;
+static uint32_t render_coverage[render_coverage_len];
+
+// debug overlay, see 'debug_overlay' in 'defs.hpp'
+static bool debug_overlay_visible = true;
+// rendered pixels of the current scanline where colliding sprites overlap and
+// where a collision was reported, bits as in 'render_coverage'
+static uint32_t debug_overlap_pixels[render_coverage_len];
+static uint32_t debug_collision_pixels[render_coverage_len];
+// slowest scanline of previous frame and of current frame in profiler ticks
+static uint32_t debug_scanline_ticks_max = 1;
+static uint32_t debug_scanline_ticks_max_frame = 0;
+// text in top left corner and time of previous frame in micro seconds
+static char debug_text[16];
+static uint32_t debug_frame_us = 0;
+
+// sprites on screen ordered by layer, built every frame in 'render(...)'
+// allocated in 'setup()'
+static constexpr int render_sprites_size_B = sizeof(sprite *) * sprites_count;
+static sprite **render_sprites = nullptr;
+static sprite **render_sprites_end = nullptr;
+
+// union of 'col_bits' and 'col_mask' of objects with 'col_mode_pixel' of
+// sprites in 'render_sprites' by layer, built every frame in 'render(...)'
+// note. sprite whose object bits and mask do not intersect the union of the
+//       layer can not collide and is rendered without collision detection
+static collision_bits render_layer_col_bits[sprites_layers];
+static collision_bits render_layer_col_mask[sprites_layers];
+
+// sprites on the current scanline that may collide when 'collision_detection'
+// uses masks
 // allocated in 'setup()'
-static constexpr int collision_map_size_B =
-    sizeof(sprite_ix) * display_width * display_height;
-static sprite_ix *collision_map = nullptr;
+static sprite **collision_sprites = nullptr;
 
 // statistics about ratio of busy DMA before sending new buffer (higher is
 // better meaning DMA is not finished before rendering)
 static int dma_busy = 0;
 static int dma_writes = 0;
 
+// parameters of rendering tuned at runtime from the serial console
+// note. applied between frames after queued DMA transfers are done
+static const console_param console_params[] = {
+    {"scanlines", 2, dma_n_scanlines_max, [] { return dma_n_scanlines; },
+     [](const int v) -> bool {
+       if (v % 2) {
+         // note. doubled lines are copied within a buffer
+         return false;
+       }
+       display.dmaWaitQueued(0);
+       dma_n_scanlines = v;
+       return true;
+     },
+     "scanlines rendered before DMA transfer, even number"},
+    {"dma_bufs", 2, dma_buf_count, [] { return dma_bufs_used; },
+     [](const int v) -> bool {
+       display.dmaWaitQueued(0);
+       dma_bufs_used = v;
+       dma_buf_ix = 0;
+       return true;
+     },
+     "DMA buffers in the ring"},
+    {"collisions", 0, 1, [] { return int(collisions_enabled); },
+     [](const int v) -> bool {
+       collisions_enabled = v;
+       return true;
+     },
+     "collision detection"},
+    {"tile_cache", 0, 1, [] { return int(tile_scanline_cache_enabled); },
+     [](const int v) -> bool {
+       tile_scanline_cache_enabled = v;
+       return true;
+     },
+     "tile scanline cache, see 'tile_scanline_cache_lines' in 'defs.hpp'"},
+    {"partial", 0, 1, [] { return int(partial_frames_enabled); },
+     [](const int v) -> bool {
+       partial_frames_enabled = v;
+       return true;
+     },
+     "partial frames, see 'partial_frames' in 'defs.hpp'"},
+    {"resolution", 0, 3, [] { return int(rendering_resolution); },
+     [](const int v) -> bool {
+       rendering_resolution = render_resolution(v);
+       return true;
+     },
+     "0: full, 1: pixels doubled, 2: lines doubled, 3: both"},
+    {"overlay", 0, 1, [] { return int(debug_overlay_visible); },
+     [](const int v) -> bool {
+       if (!debug_overlay) {
+         // note. overlay not compiled
+         return false;
+       }
+       if (debug_overlay_visible != bool(v)) {
+         // note. partial frames would leave overlay pixels on screen
+         frame_damage.add_full();
+       }
+       debug_overlay_visible = v;
+       return true;
+     },
+     "debug overlay, see 'debug_overlay' in 'defs.hpp'"},
+};
+
+static console<64> serial_console{
+    console_params, sizeof(console_params) / sizeof(console_params[0])};
+
+// telemetry records written by 'loop()' and read by 'telemetry_task(...)'
+static telemetry_ring<telemetry_ring_size_B> telemetry{};
+// time of previous frame in micro seconds
+static uint32_t telemetry_frame_us = 0;
+
+// writes telemetry records to the serial port
+// note. runs on core 0 while 'loop()' runs on core 1
+static void telemetry_task(void *) {
+  while (true) {
+    int size_B = 0;
+    uint8_t const *data = telemetry.peek(size_B);
+    if (!size_B) {
+      vTaskDelay(1);
+      continue;
+    }
+    Serial.write(data, size_t(size_B));
+    telemetry.consume(size_B);
+  }
+}
+
+// loads tile map rows from file before they are scrolled into view
+// note. runs on core 0 while 'loop()' runs on core 1
+static void tile_map_prefetch_task(void *) {
+  while (true) {
+    if (!tile_map.prefetch()) {
+      vTaskDelay(1);
+    }
+  }
+}
+
 void setup() {
   // setup rgb led pins
   pinMode(CYD_LED_RED, OUTPUT);
@@ -108,12 +287,17 @@ void setup() {
   printf("            object: %zu B\n", sizeof(object));
   printf("              tile: %zu B\n", sizeof(tiles[0]));
   printf("------------------- in program memory --------------------\n");
-  printf("     sprite images: %zu B\n", sizeof(sprite_imgs));
-  printf("             tiles: %zu B\n", sizeof(tiles));
+  printf("     sprite images: %zu B\n", sizeof(sprite_imgs_progmem));
+  printf("             tiles: %zu B\n", sizeof(tiles_progmem));
+  printf("      tile map rle: %zu B\n",
+         sizeof(tile_map_rle) + sizeof(tile_map_rle_rows));
   printf("------------------- globals ------------------------------\n");
   printf("          tile map: %zu B\n", sizeof(tile_map));
   printf("           sprites: %zu B\n", sizeof(sprites));
   printf("           objects: %zu B\n", sizeof(objects));
+  printf("        collisions: %zu B\n", sizeof(collisions));
+  printf("      spatial hash: %zu B\n", sizeof(spatial_hash));
+  printf("     collision row: %zu B\n", sizeof(collision_row));
 
   // set rgb led to yellow
   digitalWrite(CYD_LED_RED, LOW);
@@ -133,20 +317,35 @@ void setup() {
   display.setRotation(display_orientation);
   display.setAddrWindow(0, 0, display_width, display_height);
   display.initDMA(true);
+  // 'render(...)' sleeps until notified of completed transfers when all DMA
+  // buffers are queued
+  // note. 'setup()' and 'loop()' run in the same task
+  display.dmaSetNotifyTask(xTaskGetCurrentTaskHandle());
+  // the display is the only device on the bus; holding the bus streams the
+  // queued bands without bus arbitration and chip select toggling between them
+  // note. the bus is held only while writing with DMA; it is released around
+  //       non DMA writes to the display
+  // note. chip select toggles between transfers when the IDF does not provide
+  //       'SPI_TRANS_CS_KEEP_ACTIVE'
+  display.dmaHoldBus(true);
 
-  dma_buf_1 = static_cast<uint16_t *>(
-      heap_caps_calloc(1, dma_buf_size_B, MALLOC_CAP_DMA));
-  dma_buf_2 = static_cast<uint16_t *>(
-      heap_caps_calloc(1, dma_buf_size_B, MALLOC_CAP_DMA));
-  if (!dma_buf_1 || !dma_buf_2) {
-    printf("!!! could not allocate DMA buffers\n");
-    exit(1);
+  for (int i = 0; i < dma_buf_count; i++) {
+    dma_bufs[i] = static_cast<uint16_t *>(
+        heap_caps_calloc(1, dma_buf_size_B, MALLOC_CAP_DMA));
+    if (!dma_bufs[i]) {
+      printf("!!! could not allocate DMA buffers\n");
+      exit(1);
+    }
   }
 
-  collision_map = static_cast<sprite_ix *>(
-      calloc(display_width * display_height, sizeof(sprite_ix)));
-  if (!collision_map) {
-    printf("!!! could not allocate collision map\n");
+  render_sprites = static_cast<sprite **>(calloc(1, render_sprites_size_B));
+  if (collision_detection == collision_detector_masks) {
+    collision_sprites =
+        static_cast<sprite **>(calloc(1, render_sprites_size_B));
+  }
+  if (!render_sprites ||
+      (collision_detection == collision_detector_masks && !collision_sprites)) {
+    printf("!!! could not allocate render sprites list\n");
     exit(1);
   }
 
@@ -156,18 +355,54 @@ void setup() {
 
   engine_setup();
 
+  // replace resources in program memory with asset pack if available
+  if (LittleFS.begin(false) && LittleFS.exists(asset_pack_file) &&
+      engine_load_asset_pack(asset_pack_path)) {
+    printf("loaded asset pack '%s'\n", asset_pack_path);
+    // tile map rows are read from file by a task on the other core
+    tile_map.set_prefetch(true);
+    xTaskCreatePinnedToCore(tile_map_prefetch_task, "tile_map_prefetch", 4096,
+                            nullptr, 1, nullptr, 0);
+  }
+
   main_setup();
 
+  if (telemetry_enabled) {
+    // note. lower priority than tile map prefetch
+    xTaskCreatePinnedToCore(telemetry_task, "telemetry", 2048, nullptr, 0,
+                            nullptr, 0);
+  }
+
+  // cache of tile scanlines uses heap left after setup
+  // note. allocated last, one line at a time since large contiguous blocks
+  //       are not available
+  while (tile_scanline_cache_lines &&
+         ESP.getFreeHeap() >= unsigned(tile_scanline_cache_heap_reserve_B) +
+                                  display_width * sizeof(uint16_t)) {
+    uint16_t *line =
+        static_cast<uint16_t *>(malloc(display_width * sizeof(uint16_t)));
+    if (!line) {
+      break;
+    }
+    if (!tile_scanline_cache.add_line(line)) {
+      free(line);
+      break;
+    }
+  }
+
   // set rgb led to green
   digitalWrite(CYD_LED_RED, HIGH);
   digitalWrite(CYD_LED_GREEN, LOW);
   digitalWrite(CYD_LED_BLUE, HIGH);
 
   printf("------------------- on heap ------------------------------\n");
-  printf("   DMA buf 1 and 2: %d B\n", 2 * dma_buf_size_B);
+  printf("       DMA buffers: %d B\n", dma_buf_count * dma_buf_size_B);
   printf("      sprites data: %d B\n", sprites.allocated_data_size_B());
   printf("      objects data: %d B\n", objects.allocated_data_size_B());
-  printf("     collision map: %d B\n", collision_map_size_B);
+  printf("    render sprites: %d B\n", render_sprites_size_B);
+  printf("    tile scanlines: %zu B (%d of %d lines)\n",
+         tile_scanline_cache.lines_count() * display_width * sizeof(uint16_t),
+         tile_scanline_cache.lines_count(), tile_scanline_cache_lines);
   printf("------------------- after setup --------------------------\n");
   printf("     free heap mem: %u B\n", ESP.getFreeHeap());
   printf("largest free block: %u B\n", ESP.getMaxAllocHeap());
@@ -179,164 +414,823 @@ void setup() {
 void loop() {
   if (clk.on_frame(clk::time(millis()))) {
     // note. not in 'engine_loop()' due to dependency on 'millis()'
-    printf("t=%06lu  fps=%02d  dma=%03d  ldr=%03u  objs=%03d  sprs=%03d\n",
-           clk.ms, clk.fps, dma_busy * 100 / dma_writes, analogRead(CYD_LDR),
-           objects.allocated_list_len(), sprites.allocated_list_len());
+    if (telemetry_enabled) {
+      const telemetry_status st{uint32_t(clk.ms), ESP.getFreeHeap(),
+                                telemetry.dropped(), uint16_t(clk.fps),
+                                uint16_t(analogRead(CYD_LDR))};
+      telemetry.write(telemetry_type_status, st);
+      const telemetry_stores ss{uint32_t(clk.ms),
+                                objects.allocations(),
+                                objects.failed_allocations(),
+                                sprites.allocations(),
+                                sprites.failed_allocations(),
+                                uint16_t(objects.peak_allocated()),
+                                uint16_t(sprites.peak_allocated())};
+      telemetry.write(telemetry_type_stores, ss);
+    } else {
+      // note. no DMA writes if nothing changed in partial frame
+      // note. peak number of allocated in parenthesis and failed allocations
+      printf("t=%06lu  fps=%02d  dma=%03d  ldr=%03u  objs=%03d(%03d)  "
+             "sprs=%03d(%03d)  fail=%u/%u\n",
+             clk.ms, clk.fps, dma_writes ? dma_busy * 100 / dma_writes : 0,
+             analogRead(CYD_LDR), objects.allocated_list_len(),
+             objects.peak_allocated(), sprites.allocated_list_len(),
+             sprites.peak_allocated(), unsigned(objects.failed_allocations()),
+             unsigned(sprites.failed_allocations()));
+    }
+    if (profiler_enabled) {
+      // note. ticks are cpu cycles on device
+      profiler.report(ESP.getCpuFreqMHz());
+    }
+  }
+
+  {
+    profiler_scope prof{prof_touch};
+    if (touch_screen.tirqTouched() && touch_screen.touched()) {
+      const TS_Point pt = touch_screen.getPoint();
+      main_on_touch(pt.x, pt.y, pt.z);
+    }
   }
 
-  if (touch_screen.tirqTouched() && touch_screen.touched()) {
-    const TS_Point pt = touch_screen.getPoint();
-    main_on_touch(pt.x, pt.y, pt.z);
+  // commands from serial console applied before the frame
+  while (Serial.available() > 0) {
+    serial_console.feed(char(Serial.read()));
   }
 
+  const uint32_t engine_begin_us = micros();
+
   engine_loop();
+
+  if (telemetry_enabled) {
+    const uint32_t now_us = micros();
+    const telemetry_frame fr{uint32_t(clk.ms),
+                             now_us - telemetry_frame_us,
+                             now_us - engine_begin_us,
+                             uint16_t(objects.allocated_list_len()),
+                             uint16_t(sprites.allocated_list_len()),
+                             uint16_t(dma_writes),
+                             uint16_t(dma_busy),
+                             uint16_t(objects.freed_last_apply()),
+                             uint16_t(sprites.freed_last_apply())};
+    telemetry_frame_us = now_us;
+    telemetry.write(telemetry_type_frame, fr);
+  }
+
+  if (profiler_enabled) {
+    profiler.frame_end();
+  }
 }
 
-// renders a scanline
-// note. inline because it is only called from one location in render(...)
-static inline void render_scanline(uint16_t *render_buf_ptr,
-                                   sprite_ix *collision_map_row_ptr, int tile_x,
-                                   int tile_x_fract,
-                                   tile_ix const *tiles_map_row_ptr,
-                                   const int16_t scanline_y,
-                                   const int tile_line_times_tile_width) {
+// returns true if sprite may collide with other sprites on screen in the layer
+// using pixels
+static inline auto sprite_may_collide(sprite const *spr) -> bool {
+  object const *obj = spr->obj;
+  return obj->col_mode == col_mode_pixel &&
+         ((obj->col_mask & render_layer_col_bits[spr->layer]) ||
+          (obj->col_bits & render_layer_col_mask[spr->layer]));
+}
 
-  // used later by sprite renderer to overwrite tiles pixels
-  uint16_t *scanline_ptr = render_buf_ptr;
+// renders pixels 'x' to 'x_end' of rendered scanline from tiles
+static inline void render_tiles_span(uint16_t *scanline_ptr, const int x,
+                                     const int x_end, const int tile_x,
+                                     const int tile_x_fract,
+                                     tile_ix const *tiles_map_row_ptr,
+                                     const int tile_line_times_tile_width) {
+  // increment of pixels in tile for every rendered pixel
+  const int x_inc = 1 << render_x_shift;
+  // x in tile map row relative to first tile on screen
+  const int map_x = tile_x_fract + (x << render_x_shift);
   // pointer to first tile to render
-  tile_ix const *tiles_map_ptr = tiles_map_row_ptr + tile_x;
-  // for all horizontal pixels
-  int remaining_x = display_width;
+  tile_ix const *tiles_map_ptr =
+      tiles_map_row_ptr + tile_x + (map_x >> tile_width_shift);
+  // first pixel in tile image to render
+  int tile_img_x = map_x & (tile_width - 1);
+  uint16_t *dst = scanline_ptr + x;
+  int remaining_x = x_end - x;
   while (remaining_x) {
     // pointer to tile image to render
-    uint8_t const *tile_img_ptr =
-        tiles[*tiles_map_ptr] + tile_line_times_tile_width + tile_x_fract;
+    uint8_t const *tile_img_ptr = tiles[*tiles_map_ptr];
+    // index of first pixel in tile image to render
+    int tile_img_ix = tile_line_times_tile_width + tile_img_x;
     // calculate number of pixels to render
-    int render_n_pixels = 0;
-    if (tile_x_fract) {
-      // can only happen at first tile in row
-      render_n_pixels = tile_width - tile_x_fract;
-      if (render_n_pixels > remaining_x) {
-        // tile width + 1 is greater than screen width
-        render_n_pixels = remaining_x;
-      }
-      tile_x_fract = 0;
-    } else {
-      render_n_pixels = remaining_x < tile_width ? remaining_x : tile_width;
+    int render_n_pixels =
+        (tile_width - tile_img_x + x_inc - 1) >> render_x_shift;
+    if (render_n_pixels > remaining_x) {
+      // first tile or last tile
+      render_n_pixels = remaining_x;
     }
     // decrease remaining pixels to render before using that variable
     remaining_x -= render_n_pixels;
+    // first pixel in next tile, 1 if last pixel in this tile was skipped
+    tile_img_x += (render_n_pixels << render_x_shift) - tile_width;
     while (render_n_pixels--) {
-      *render_buf_ptr++ = palette_tiles[*tile_img_ptr++];
+      *dst++ = palette_tiles[img_pixel<tiles_bpp>(tile_img_ptr, tile_img_ix)];
+      tile_img_ix += x_inc;
     }
     // next tile
     tiles_map_ptr++;
   }
+}
+
+// returns scanline 'map_y' in tile map rendered from tiles only from
+// 'tile_scanline_cache', rendering it if not cached, or nullptr if it cannot be
+// cached
+static inline auto render_tiles_cached(const int map_y, const int tile_x,
+                                       const int tile_x_fract,
+                                       tile_ix const *tiles_map_row_ptr,
+                                       const int tile_line_times_tile_width)
+    -> uint16_t const * {
+  bool cached = false;
+  uint16_t *line = tile_scanline_cache.line(map_y, cached);
+  if (line && !cached) {
+    render_tiles_span(line, 0, render_width, tile_x, tile_x_fract,
+                      tiles_map_row_ptr, tile_line_times_tile_width);
+  }
+  return line;
+}
+
+// renders pixels 'x' to 'x_end' of rendered scanline by copying from
+// 'tiles_line' or if nullptr from tiles
+static inline void render_tiles(uint16_t *scanline_ptr,
+                                uint16_t const *tiles_line, const int x,
+                                const int x_end, const int tile_x,
+                                const int tile_x_fract,
+                                tile_ix const *tiles_map_row_ptr,
+                                const int tile_line_times_tile_width) {
+  if (tiles_line) {
+    memcpy(scanline_ptr + x, tiles_line + x,
+           size_t(x_end - x) * sizeof(uint16_t));
+  } else {
+    render_tiles_span(scanline_ptr, x, x_end, tile_x, tile_x_fract,
+                      tiles_map_row_ptr, tile_line_times_tile_width);
+  }
+}
+
+// returns first rendered pixel from 'x' in the current scanline that is
+// 'covered' or not or 'render_width' if none
+static inline auto render_coverage_find(int x, const bool covered) -> int {
+  while (x < render_width) {
+    uint32_t bits = render_coverage[x >> 5];
+    if (!covered) {
+      bits = ~bits;
+    }
+    bits >>= x & 31;
+    if (bits) {
+      x += __builtin_ctz(bits);
+      return x < render_width ? x : render_width;
+    }
+    // next word
+    x = (x | 31) + 1;
+  }
+  return render_width;
+}
+
+// returns true if sprite pixel at rendered 'x' in current scanline should be
+// written
+// note. when rendering front to back marks the pixel as covered
+static inline auto render_pixel_claim(const int x) -> bool {
+  if (rendering_order == render_back_to_front) {
+    return true;
+  }
+  uint32_t &word = render_coverage[x >> 5];
+  const uint32_t bit = uint32_t(1) << (x & 31);
+  if (word & bit) {
+    return false;
+  }
+  word |= bit;
+  return true;
+}
+
+// returns rgb 565 color with bytes swapped as in the palettes
+static constexpr auto debug_color(const int r, const int g, const int b)
+    -> uint16_t {
+  return uint16_t(((r >> 3) << 11 | (g >> 2) << 5 | b >> 3) >> 8 |
+                  ((r >> 3) << 11 | (g >> 2) << 5 | b >> 3) << 8);
+}
+
+// returns 3 x 5 pixels glyph of 'ch', rows from top in octal digits where the
+// highest bit is the leftmost pixel
+static auto debug_glyph(const char ch) -> uint16_t {
+  static constexpr uint16_t digits[]{
+      075557, 026227, 071747,
+      071717, 055711, 074717,
+      074757, 071111, 075757,
+      075717};
+  switch (ch) {
+  case 'F':
+    return 074644;
+  case 'P':
+    return 075744;
+  case 'S':
+    return 074717;
+  case 'M':
+    return 057755;
+  default:
+    return ch >= '0' && ch <= '9' ? digits[ch - '0'] : 0;
+  }
+}
+
+// marks rendered pixel 'x' in 'bits'
+static inline void debug_mark(uint32_t *bits, const int x) {
+  bits[x >> 5] |= uint32_t(1) << (x & 31);
+}
+
+// draws the debug overlay on rendered scanline that took 'ticks' to render
+static void debug_overlay_scanline(uint16_t *scanline_ptr,
+                                   const int16_t scanline_y,
+                                   const uint32_t ticks) {
+  constexpr uint16_t color_overlap = debug_color(255, 255, 0);
+  constexpr uint16_t color_collision = debug_color(255, 0, 0);
+  constexpr uint16_t color_box_pixels = debug_color(0, 255, 0);
+  constexpr uint16_t color_box_shape = debug_color(0, 255, 255);
+  constexpr uint16_t color_box = debug_color(128, 128, 128);
+  constexpr uint16_t color_text = debug_color(255, 255, 255);
+  constexpr uint16_t color_text_bg = debug_color(0, 0, 0);
+  constexpr int heat_bar_width = 4;
+  constexpr int text_x = 2;
+  constexpr int text_y = 2;
+  constexpr int text_scale = 2;
+
+  // pixels of colliding sprites
+  for (int i = 0; i < render_coverage_len; i++) {
+    uint32_t bits = debug_overlap_pixels[i] | debug_collision_pixels[i];
+    while (bits) {
+      const int bit = __builtin_ctz(bits);
+      bits &= bits - 1;
+      const int x = (i << 5) + bit;
+      scanline_ptr[x] = debug_collision_pixels[i] & (uint32_t(1) << bit)
+                            ? color_collision
+                            : color_overlap;
+    }
+    debug_overlap_pixels[i] = debug_collision_pixels[i] = 0;
+  }
+
+  // bounding boxes of sprites
+  sprite *const *const end = render_sprites_end;
+  for (sprite *const *it = render_sprites; it < end; it++) {
+    sprite const *spr = *it;
+    const int spr_y = scanline_y - spr->scr_y;
+    const int spr_height = spr->h * sprite_height;
+    if (spr_y < 0 || spr_y >= spr_height) {
+      continue;
+    }
+    object const *obj = spr->obj;
+    const uint16_t color =
+        sprite_may_collide(spr) ? color_box_pixels
+        : obj->col_mode != col_mode_pixel && (obj->col_bits || obj->col_mask)
+            ? color_box_shape
+            : color_box;
+    const int spr_x_end = spr->scr_x + spr->w * sprite_width;
+    const int x = (spr->scr_x < 0 ? 0 : spr->scr_x) >> render_x_shift;
+    const int x_last =
+        ((spr_x_end > display_width ? display_width : spr_x_end) - 1) >>
+        render_x_shift;
+    if (spr_y == 0 || spr_y == spr_height - 1) {
+      for (int i = x; i <= x_last; i++) {
+        scanline_ptr[i] = color;
+      }
+      continue;
+    }
+    if (spr->scr_x >= 0) {
+      scanline_ptr[x] = color;
+    }
+    if (spr_x_end <= display_width) {
+      scanline_ptr[x_last] = color;
+    }
+  }
+
+  // heat bar of rendering time from green to red
+  if (ticks > debug_scanline_ticks_max_frame) {
+    debug_scanline_ticks_max_frame = ticks;
+  }
+  const uint32_t heat = ticks >= debug_scanline_ticks_max
+                            ? 31
+                            : ticks * 31 / debug_scanline_ticks_max;
+  const uint16_t heat_color =
+      debug_color(int(heat) << 3, int(31 - heat) << 3, 0);
+  for (int i = render_width - heat_bar_width; i < render_width; i++) {
+    scanline_ptr[i] = heat_color;
+  }
+
+  // text
+  const int text_row = (scanline_y - text_y) / text_scale;
+  if (scanline_y >= text_y && text_row < 5) {
+    int x = text_x;
+    for (char const *ch = debug_text; *ch; ch++) {
+      const uint16_t glyph = debug_glyph(*ch);
+      const int row_bits = glyph >> ((4 - text_row) * 3) & 7;
+      for (int col = 0; col < 4 * text_scale; col++) {
+        const int px = x + col;
+        if (px >= render_width) {
+          break;
+        }
+        const int glyph_col = col / text_scale;
+        scanline_ptr[px] = glyph_col < 3 && (row_bits >> (2 - glyph_col) & 1)
+                               ? color_text
+                               : color_text_bg;
+      }
+      x += 4 * text_scale;
+    }
+  }
+}
+
+// renders a scanline or if not 'paint' only detects collisions
+// note. inline because it is only called from one location in render(...)
+static inline void render_scanline(uint16_t *render_buf_ptr, const int tile_x,
+                                   const int tile_x_fract,
+                                   tile_ix const *tiles_map_row_ptr,
+                                   const int16_t scanline_y,
+                                   const int tile_line_times_tile_width,
+                                   const int map_y, const bool paint) {
+
+  // used later by sprite renderer to overwrite tiles pixels
+  uint16_t *scanline_ptr = render_buf_ptr;
+
+  profiler_scope prof{prof_render_tiles};
+
+  // ticks at start of scanline for the heat bar of the debug overlay
+  const uint32_t debug_begin = debug_overlay ? profiler_ticks() : 0;
+
+  // scanline rendered from tiles only if cached
+  uint16_t const *tiles_line = nullptr;
+  if (paint && tile_scanline_cache_lines && tile_scanline_cache_enabled) {
+    tiles_line = render_tiles_cached(map_y, tile_x, tile_x_fract,
+                                     tiles_map_row_ptr,
+                                     tile_line_times_tile_width);
+  }
+
+  if (paint) {
+    if (rendering_order == render_back_to_front) {
+      render_tiles(scanline_ptr, tiles_line, 0, render_width, tile_x,
+                   tile_x_fract, tiles_map_row_ptr, tile_line_times_tile_width);
+    } else {
+      memset(render_coverage, 0, sizeof(render_coverage));
+    }
+  }
 
   // render sprites
+  prof.next(prof_render_sprites);
   // note. although grossly inefficient algorithm the DMA is mostly busy while
   //       rendering
 
-  for (int layer = 0; layer < sprites_layers; layer++) {
-    sprite *spr = sprites.all_list();
-    const int len = sprites.all_list_len();
-    // note. "constexpr int len" does not compile
-    for (int i = 0; i < len; i++, spr++) {
-      if (spr->layer != layer || !spr->img || spr->scr_y > scanline_y ||
-          spr->scr_y + sprite_height <= scanline_y ||
-          spr->scr_x <= -sprite_width || spr->scr_x >= display_width) {
-        // sprite not in current layer or
-        // sprite has no image or
-        // not within scanline or
-        // is outside the screen x-wise
-        continue;
-      }
-      // pointer to sprite image to be rendered
-      uint8_t const *spr_img_ptr = spr->img;
-      // extract sprite flip
-      const bool flip_horiz = spr->flip & 1;
-      const bool flip_vert = spr->flip & 2;
-      if (flip_vert) {
-        spr_img_ptr += (sprite_height - 1) * sprite_width -
-                       (scanline_y - spr->scr_y) * sprite_width;
-      } else {
-        spr_img_ptr += (scanline_y - spr->scr_y) * sprite_width;
+  if (collision_detection == collision_detector_pixels && collisions_enabled) {
+    // clear collisions of previous scanline
+    // note. works on other sizes of type 'sprite_ix' because reserved value is
+    //       unsigned maximum value such as 0xff or 0xffff etc
+    memset(collision_row, sprite_ix_reserved, sizeof(collision_row));
+  }
+
+  // sprites are ordered by layer
+  // note. when rendering front to back the sprites are iterated in reverse
+  //       order and the collision row holds the sprite rendered before in that
+  //       order, which gives the same pairs and contact points
+  const int render_sprites_len = int(render_sprites_end - render_sprites);
+  for (int i = 0; i < render_sprites_len; i++) {
+    sprite *spr =
+        render_sprites[rendering_order == render_back_to_front
+                           ? i
+                           : render_sprites_len - 1 - i];
+    // sprite dimensions in pixels
+    const int spr_width = spr->w * sprite_width;
+    const int spr_height = spr->h * sprite_height;
+    if (spr->scr_y > scanline_y || spr->scr_y + spr_height <= scanline_y) {
+      // not within scanline
+      continue;
+    }
+    // true if pixels are checked for collisions with other sprites
+    const bool collides = collision_detection == collision_detector_pixels &&
+                          sprite_may_collide(spr);
+    if (!paint && !collides) {
+      // nothing to do
+      continue;
+    }
+    // extract sprite flip
+    const bool flip_horiz = spr->flip & 1;
+    const bool flip_vert = spr->flip & 2;
+    // line in sprite to be rendered
+    int spr_y = scanline_y - spr->scr_y;
+    if (flip_vert) {
+      spr_y = spr_height - 1 - spr_y;
+    }
+    // images of the cells in the row of the line to be rendered
+    uint8_t const *const *cells_row_ptr =
+        spr->imgs ? spr->imgs + (spr_y / sprite_height) * spr->w : &spr->img;
+    // index of first pixel of the line in a cell image
+    const int cell_line_ix = (spr_y % sprite_height) * sprite_width;
+    // increment of sprite pixel for every rendered pixel
+    const int x_inc = 1 << render_x_shift;
+    // increment to next sprite pixel to be rendered
+    const int spr_img_ix_inc = flip_horiz ? -x_inc : x_inc;
+    // range of pixels in sprite line that are on screen
+    int x = spr->scr_x < 0 ? -spr->scr_x : 0;
+    const int x_end = spr->scr_x + spr_width > display_width
+                          ? display_width - spr->scr_x
+                          : spr_width;
+    if ((spr->scr_x + x) & (x_inc - 1)) {
+      // first pixel is between rendered pixels
+      x++;
+    }
+    // rendered x of first pixel of sprite
+    const int dst_x = (spr->scr_x + x) >> render_x_shift;
+    // pointer to destination of sprite data
+    uint16_t *scanline_dst_ptr = scanline_ptr + dst_x;
+    // pointer to collision row for first pixel of sprite
+    sprite_ix *collision_pixel = collision_row + dst_x;
+    // index of sprite written to collision row
+    const sprite_ix spr_ix = sprite_ix(spr - sprites.all_list());
+    // palette bank of sprite
+    uint16_t const *palette = palette_sprites[spr->palette];
+    object *obj = spr->obj;
+    // index of sprite in collision at previous pixel
+    // note. avoids adding the same collision for every pixel
+    sprite_ix prv_col_spr_ix = sprite_ix_reserved;
+    while (x < x_end) {
+      // pixel in sprite line considering flip
+      const int spr_x = flip_horiz ? spr_width - 1 - x : x;
+      const int cell_x = spr_x % sprite_width;
+      // pointer to cell image to be rendered
+      uint8_t const *spr_img_ptr = cells_row_ptr[spr_x / sprite_width];
+      // index of sprite image pixel to be rendered
+      int spr_img_ix = cell_line_ix + cell_x;
+      // increment to next pixel in cell image
+      int img_ix_inc = spr_img_ix_inc;
+      // flip of cell image applied before flip of sprite
+      const int img_flip = sprite_img_flip(spr_img_ptr);
+      if (img_flip) {
+        spr_img_ptr = sprite_img_data(spr_img_ptr);
+        const int line_ix = img_flip & 2
+                                ? (sprite_height - 1) * sprite_width -
+                                      cell_line_ix
+                                : cell_line_ix;
+        if (img_flip & 1) {
+          spr_img_ix = line_ix + sprite_width - 1 - cell_x;
+          img_ix_inc = -img_ix_inc;
+        } else {
+          spr_img_ix = line_ix + cell_x;
+        }
       }
-      if (flip_horiz) {
-        // start at end of sprite line
-        spr_img_ptr += sprite_width - 1;
+      // number of pixels to render from this cell
+      int render_n_pixels = flip_horiz ? cell_x + 1 : sprite_width - cell_x;
+      if (render_n_pixels > x_end - x) {
+        render_n_pixels = x_end - x;
       }
-      // increment to next sprite pixel to be rendered
-      const int spr_img_ptr_inc = flip_horiz ? -1 : 1;
-      // pointer to destination of sprite data
-      uint16_t *scanline_dst_ptr = scanline_ptr + spr->scr_x;
-      // initial number of pixels to be rendered
-      int render_n_pixels = sprite_width;
-      // pointer to collision map for first pixel of sprite
-      sprite_ix *collision_pixel = collision_map_row_ptr + spr->scr_x;
-      if (spr->scr_x < 0) {
-        // adjustments if sprite x is negative
-        if (flip_horiz) {
-          spr_img_ptr += spr->scr_x;
-        } else {
-          spr_img_ptr -= spr->scr_x;
+      // number of rendered pixels from this cell
+      render_n_pixels = (render_n_pixels + x_inc - 1) >> render_x_shift;
+      x += render_n_pixels << render_x_shift;
+      if (!collides) {
+        // render line from cell to scanline
+        while (render_n_pixels--) {
+          const uint8_t color_ix =
+              img_pixel<sprites_bpp>(spr_img_ptr, spr_img_ix);
+          if (color_ix &&
+              render_pixel_claim(int(scanline_dst_ptr - scanline_ptr))) {
+            *scanline_dst_ptr = palette[color_ix];
+          }
+          spr_img_ix += img_ix_inc;
+          scanline_dst_ptr++;
         }
-        scanline_dst_ptr -= spr->scr_x;
-        render_n_pixels += spr->scr_x;
-        collision_pixel -= spr->scr_x;
-      } else if (spr->scr_x + sprite_width > display_width) {
-        // adjustment if sprite partially outside screen (x-wise)
-        render_n_pixels = display_width - spr->scr_x;
+        // note. collision row is not used by sprite
+        continue;
       }
-      // render line from sprite to scanline and check collisions
-      object *obj = spr->obj;
+      // render line from cell to scanline and check collisions
       while (render_n_pixels--) {
         // write pixel from sprite data or skip if 0
-        const uint8_t color_ix = *spr_img_ptr;
+        const uint8_t color_ix =
+            img_pixel<sprites_bpp>(spr_img_ptr, spr_img_ix);
         if (color_ix) {
           // if not transparent pixel
-          *scanline_dst_ptr = palette_sprites[color_ix];
-          if (*collision_pixel != sprite_ix_reserved) {
-            // if other sprite has written to this pixel
+          if (paint &&
+              render_pixel_claim(int(scanline_dst_ptr - scanline_ptr))) {
+            *scanline_dst_ptr = palette[color_ix];
+          }
+          if (debug_overlay && debug_overlay_visible &&
+              *collision_pixel != sprite_ix_reserved) {
+            debug_mark(debug_overlap_pixels,
+                       int(scanline_dst_ptr - scanline_ptr));
+          }
+          if (*collision_pixel != sprite_ix_reserved &&
+              *collision_pixel != prv_col_spr_ix) {
+            // if other sprite, not the same as previous pixel, has written to
+            // this pixel
+            prv_col_spr_ix = *collision_pixel;
             sprite *other_spr = sprites.instance(*collision_pixel);
             if (spr->layer == other_spr->layer) {
               object *other_obj = other_spr->obj;
-              if (obj->col_mask & other_obj->col_bits) {
-                obj->col_with = other_obj;
-              }
-              if (other_obj->col_mask & obj->col_bits) {
-                other_obj->col_with = obj;
+              const bool obj_col = obj->col_mask & other_obj->col_bits;
+              const bool other_obj_col = other_obj->col_mask & obj->col_bits;
+              if (obj_col || other_obj_col) {
+                // screen x of pixel in collision
+                const int16_t col_x = int16_t(
+                    (scanline_dst_ptr - scanline_ptr) << render_x_shift);
+                collisions.add(obj, other_obj, col_x, scanline_y, obj_col,
+                               other_obj_col);
+                if (debug_overlay && debug_overlay_visible) {
+                  debug_mark(debug_collision_pixels,
+                             int(scanline_dst_ptr - scanline_ptr));
+                }
               }
             }
           }
           // set pixel collision value to sprite index
-          *collision_pixel = sprite_ix(i);
+          *collision_pixel = spr_ix;
         }
-        spr_img_ptr += spr_img_ptr_inc;
+        spr_img_ix += img_ix_inc;
         collision_pixel++;
         scanline_dst_ptr++;
       }
     }
   }
+
+  if (paint && rendering_order == render_front_to_back) {
+    // render tiles in the gaps between sprites
+    prof.next(prof_render_tiles);
+    int x = render_coverage_find(0, false);
+    while (x < render_width) {
+      const int x_end = render_coverage_find(x, true);
+      render_tiles(scanline_ptr, tiles_line, x, x_end, tile_x, tile_x_fract,
+                   tiles_map_row_ptr, tile_line_times_tile_width);
+      x = render_coverage_find(x_end, false);
+    }
+  }
+
+  if (debug_overlay && debug_overlay_visible && paint) {
+    debug_overlay_scanline(scanline_ptr, scanline_y,
+                           profiler_ticks() - debug_begin);
+  }
+}
+
+// returns opacity mask of cell 'cell_x' in line 'spr_y' of sprite considering
+// flip or 0 if cell is outside the sprite
+static inline auto sprite_cell_row_mask(sprite const *spr, int spr_y,
+                                        int cell_x) -> sprite_row_mask {
+  if (cell_x < 0 || cell_x >= spr->w) {
+    return 0;
+  }
+  const bool flip_horiz = spr->flip & 1;
+  if (spr->flip & 2) {
+    spr_y = spr->h * sprite_height - 1 - spr_y;
+  }
+  if (flip_horiz) {
+    cell_x = spr->w - 1 - cell_x;
+  }
+  uint8_t const *img =
+      spr->imgs ? spr->imgs[(spr_y / sprite_height) * spr->w + cell_x]
+                : spr->img;
+  const sprite_row_mask mask =
+      sprite_imgs.row_mask(img, spr_y % sprite_height);
+  return flip_horiz ? sprite_row_mask_reversed(mask) : mask;
 }
 
-// returns number of shifts to convert a 2^n number to 1
-static constexpr int count_right_shifts_until_1(int num) {
-  return (num <= 1) ? 0 : 1 + count_right_shifts_until_1(num >> 1);
+// returns opacity mask of 'sprite_width' pixels in line 'spr_y' of sprite
+// starting at sprite relative 'x'
+static inline auto sprite_line_mask(sprite const *spr, const int spr_y,
+                                    const int x) -> sprite_row_mask {
+  // cell containing 'x' rounded towards negative infinity
+  const int cell_x = x >= 0 ? x / sprite_width
+                            : -((sprite_width - 1 - x) / sprite_width);
+  const int shift = x - cell_x * sprite_width;
+  sprite_row_mask mask = sprite_cell_row_mask(spr, spr_y, cell_x) >> shift;
+  if (shift) {
+    mask |= sprite_cell_row_mask(spr, spr_y, cell_x + 1)
+            << (sprite_width - shift);
+  }
+  return mask & sprite_row_mask_all;
+}
+
+// detects collisions between sprites on scanline using opacity masks
+// note. inline because it is only called from one location in render(...)
+static inline void collide_scanline(const int16_t scanline_y) {
+  // sprites on scanline that may collide
+  sprite **collision_sprites_end = collision_sprites;
+  sprite *const *const end = render_sprites_end;
+  for (sprite *const *it = render_sprites; it < end; it++) {
+    sprite *spr = *it;
+    if (spr->scr_y <= scanline_y &&
+        spr->scr_y + spr->h * sprite_height > scanline_y &&
+        sprite_may_collide(spr)) {
+      *collision_sprites_end++ = spr;
+    }
+  }
+  // test pairs of sprites
+  for (sprite **it1 = collision_sprites; it1 < collision_sprites_end; it1++) {
+    sprite *spr1 = *it1;
+    object *obj1 = spr1->obj;
+    const int spr1_y = scanline_y - spr1->scr_y;
+    const int spr1_x_end = spr1->scr_x + spr1->w * sprite_width;
+    for (sprite **it2 = it1 + 1; it2 < collision_sprites_end; it2++) {
+      sprite *spr2 = *it2;
+      object *obj2 = spr2->obj;
+      if (spr1->layer != spr2->layer) {
+        continue;
+      }
+      const bool obj1_col = obj1->col_mask & obj2->col_bits;
+      const bool obj2_col = obj2->col_mask & obj1->col_bits;
+      if (!obj1_col && !obj2_col) {
+        continue;
+      }
+      // overlapping pixels on screen
+      const int spr2_x_end = spr2->scr_x + spr2->w * sprite_width;
+      int x = spr1->scr_x > spr2->scr_x ? spr1->scr_x : spr2->scr_x;
+      int x_end = spr1_x_end < spr2_x_end ? spr1_x_end : spr2_x_end;
+      if (x < 0) {
+        x = 0;
+      }
+      if (x_end > display_width) {
+        x_end = display_width;
+      }
+      const int spr2_y = scanline_y - spr2->scr_y;
+      for (; x < x_end; x += sprite_width) {
+        sprite_row_mask mask = sprite_line_mask(spr1, spr1_y, x - spr1->scr_x) &
+                               sprite_line_mask(spr2, spr2_y, x - spr2->scr_x);
+        if (x_end - x < sprite_width) {
+          mask &= sprite_row_mask_all >> (sprite_width - (x_end - x));
+        }
+        if (mask) {
+          // first pixel in contact is lowest set bit
+          collisions.add(obj1, obj2, int16_t(x + __builtin_ctz(mask)),
+                         scanline_y, obj1_col, obj2_col);
+          break;
+        }
+      }
+    }
+  }
+}
+
+// expands 'render_width' pixels at start of scanline to 'display_width' by
+// doubling each pixel
+// note. from the end since source and destination overlap
+static inline void render_expand_pixels(uint16_t *scanline_ptr) {
+  uint16_t const *src = scanline_ptr + render_width;
+  uint16_t *dst = scanline_ptr + display_width;
+  while (src > scanline_ptr) {
+    const uint16_t pixel = *--src;
+    *--dst = pixel;
+    *--dst = pixel;
+  }
+}
+
+// queues 'n_pixels' of 'dma_buf' for transfer and returns next buffer in the
+// ring that is not queued
+static inline auto dma_queue(uint16_t *dma_buf, const int n_pixels)
+    -> uint16_t * {
+  dma_writes++;
+  if (display.dmaQueued() >= dma_bufs_used - 1) {
+    profiler_scope prof{prof_dma_wait};
+    // all other buffers are queued, next buffer is not free until the oldest
+    // transfer is complete
+    dma_busy++;
+    // sleep until notified by interrupt of a completed transfer
+    // note. notification given after 'dmaQueued()' is pending and returns
+    //       immediately
+    do {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    } while (display.dmaQueued() >= dma_bufs_used - 1);
+  }
+  display.pushPixelsDMAQueued(dma_buf, uint32_t(n_pixels));
+  dma_buf_ix = (dma_buf_ix + 1) % dma_bufs_used;
+  return dma_bufs[dma_buf_ix];
+}
+
+// sets the display window
+// note. waits for queued transfers and releases the bus since the window is
+//       set without DMA
+static void display_window(const int x, const int y, const int width,
+                           const int height) {
+  {
+    profiler_scope prof{prof_dma_wait};
+    display.dmaWaitQueued(0);
+  }
+  display.dmaHoldBus(false);
+  display.setAddrWindow(x, y, width, height);
+  display.dmaHoldBus(true);
+  display_window_x = x;
+  display_window_x_end = x + width;
+}
+
+// returns true if band 'ix' of a partial frame is rendered and transferred
+// note. a run of damaged bands is transferred to one display window spanning
+//       the horizontal extent of the run
+static auto partial_band_begin(const int ix) -> bool {
+  int x = 0;
+  int x_end = 0;
+  if (!frame_damage.band(ix, x, x_end)) {
+    return false;
+  }
+  int bx = 0;
+  int bx_end = 0;
+  if (ix > 0 && frame_damage.band(ix - 1, bx, bx_end)) {
+    // continues the run in the current window
+    return true;
+  }
+  // extent of the run of damaged bands
+  for (int i = ix + 1; i < dma_n_bands && frame_damage.band(i, bx, bx_end);
+       i++) {
+    x = bx < x ? bx : x;
+    x_end = bx_end > x_end ? bx_end : x_end;
+  }
+  // align to doubled pixels
+  x = x >> render_x_shift << render_x_shift;
+  x_end = (x_end + (1 << render_x_shift) - 1) >> render_x_shift
+                                                << render_x_shift;
+  // note. window to the bottom of the screen, the run ends before
+  const int y = ix * dma_n_scanlines;
+  display_window(x, y, x_end - x, display_height - y);
+  return true;
+}
+
+// queues 'n_scanlines' in 'dma_buf' for transfer and returns next buffer to
+// render
+// in partial frame only the extent of the display window of rendered bands is
+// transferred
+static auto render_band_end(uint16_t *dma_buf, const int n_scanlines,
+                            const bool partial, const bool painted)
+    -> uint16_t * {
+  if (!partial) {
+    return dma_queue(dma_buf, display_width * n_scanlines);
+  }
+  if (!painted) {
+    // nothing to transfer, buffer is reused
+    return dma_buf;
+  }
+  // pack the scanlines within the window
+  const int width = display_window_x_end - display_window_x;
+  for (int i = 0; i < n_scanlines; i++) {
+    memmove(dma_buf + i * width, dma_buf + i * display_width + display_window_x,
+            size_t(width) * sizeof(uint16_t));
+  }
+  return dma_queue(dma_buf, width * n_scanlines);
 }
 
 // renders tile map and sprites
 static void render(const int x, const int y) {
   dma_busy = dma_writes = 0;
 
-  // clear collisions map
-  // note. works on other sizes of type 'sprite_ix' because reserved value is
-  //       unsigned maximum value such as 0xff or 0xffff etc
-  memset(collision_map, sprite_ix_reserved, collision_map_size_B);
+  // resolution of this frame
+  render_x_shift = rendering_resolution & render_pixels_doubled ? 1 : 0;
+  render_width = display_width >> render_x_shift;
+  const bool lines_doubled = rendering_resolution & render_lines_doubled;
+  if (tile_scanline_cache_lines) {
+    tile_scanline_cache.begin_frame(x, y, render_x_shift);
+  }
+
+  if (debug_overlay && debug_overlay_visible) {
+    // slowest scanline of previous frame is the full heat bar
+    debug_scanline_ticks_max =
+        debug_scanline_ticks_max_frame ? debug_scanline_ticks_max_frame : 1;
+    debug_scanline_ticks_max_frame = 0;
+    const uint32_t now_us = micros();
+    const uint32_t frame_ms = (now_us - debug_frame_us) / 1000;
+    debug_frame_us = now_us;
+    snprintf(debug_text, sizeof(debug_text), "%d FPS %d MS", int(clk.fps),
+             int(frame_ms));
+  }
+
+  // partial frame if little changed since previous frame
+  // note. debug overlay is drawn over the whole frame
+  const bool partial = partial_frames && partial_frames_enabled &&
+                       !(debug_overlay && debug_overlay_visible) &&
+                       dma_n_scanlines == damage_band_height &&
+                       !frame_damage.is_full() &&
+                       frame_damage.area() * 100 <=
+                           display_width * display_height *
+                               partial_frames_max_percent;
+  if (partial) {
+    // note. transferred bands leave the write position within the window
+    display_window_full = false;
+  } else if (!display_window_full) {
+    display_window(0, 0, display_width, display_height);
+    display_window_full = true;
+  }
+  // true if current band is rendered, otherwise only collisions are detected
+  bool band_paint = true;
+
+  // build list of sprites on screen ordered by layer
+  render_sprites_end = render_sprites;
+  for (int layer = 0; layer < sprites_layers; layer++) {
+    render_layer_col_bits[layer] = render_layer_col_mask[layer] = 0;
+    sprite *spr = sprites.all_list();
+    const int len = sprites.all_list_len();
+    // note. "constexpr int len" does not compile
+    for (int i = 0; i < len; i++, spr++) {
+      if (spr->layer != layer || !spr->img ||
+          spr->scr_y <= -spr->h * sprite_height ||
+          spr->scr_y >= display_height ||
+          spr->scr_x <= -spr->w * sprite_width ||
+          spr->scr_x >= display_width) {
+        // sprite not in current layer or
+        // sprite has no image or
+        // is outside the screen
+        continue;
+      }
+      *render_sprites_end++ = spr;
+      if (collisions_enabled && spr->obj->col_mode == col_mode_pixel) {
+        render_layer_col_bits[layer] |= spr->obj->col_bits;
+        render_layer_col_mask[layer] |= spr->obj->col_mask;
+      }
+    }
+  }
 
   // extract whole number and fractions from x, y
-  constexpr int tile_width_shift = count_right_shifts_until_1(tile_width);
-  constexpr int tile_height_shift = count_right_shifts_until_1(tile_height);
   constexpr int tile_width_and = (1 << tile_width_shift) - 1;
   constexpr int tile_height_and = (1 << tile_height_shift) - 1;
   const int tile_x = x >> tile_width_shift;
@@ -346,16 +1240,12 @@ static void render(const int x, const int y) {
   // current scanline screen y
   int16_t scanline_y = 0;
   // pointer to start of current row of tiles
-  tile_ix const *tiles_map_row_ptr = tile_map[tile_y];
-  // pointer to collision map starting at top left of screen
-  sprite_ix *collision_map_row_ptr = collision_map;
+  tile_ix const *tiles_map_row_ptr = tile_map.row(tile_y);
   // keeps track of how many scanlines have been rendered since last DMA
   // transfer
   int dma_scanline_count = 0;
-  // select first buffer for rendering
-  uint16_t *render_buf_ptr = dma_buf_1;
-  // which dma buffer to use next
-  bool dma_buf_use_first = false;
+  // select buffer for rendering
+  uint16_t *render_buf_ptr = dma_bufs[dma_buf_ix];
   // pointer to the buffer that DMA will copy to screen
   uint16_t *dma_buf = render_buf_ptr;
   // for all lines on display
@@ -380,41 +1270,50 @@ static void render(const int x, const int y) {
     }
     // render a row from tile map
     while (tile_line < render_n_tile_lines) {
-      render_scanline(render_buf_ptr, collision_map_row_ptr, tile_x,
-                      tile_x_fract, tiles_map_row_ptr, scanline_y,
-                      tile_line_times_tile_width);
+      if (partial && dma_scanline_count == 0) {
+        band_paint = partial_band_begin(scanline_y / dma_n_scanlines);
+      }
+      if (lines_doubled && (scanline_y & 1)) {
+        // copy previous scanline
+        // note. in the same buffer since 'dma_n_scanlines' is even
+        if (band_paint) {
+          memcpy(render_buf_ptr, render_buf_ptr - display_width,
+                 display_width * sizeof(uint16_t));
+        }
+      } else {
+        render_scanline(render_buf_ptr, tile_x, tile_x_fract,
+                        tiles_map_row_ptr, scanline_y,
+                        tile_line_times_tile_width, y + scanline_y,
+                        band_paint);
+        if (collision_detection == collision_detector_masks &&
+            collisions_enabled) {
+          profiler_scope prof{prof_render_collisions};
+          collide_scanline(scanline_y);
+        }
+        if (band_paint && render_x_shift) {
+          render_expand_pixels(render_buf_ptr);
+        }
+      }
       tile_line++;
       tile_line_times_tile_width += tile_width;
       render_buf_ptr += display_width;
-      collision_map_row_ptr += display_width;
       scanline_y++;
       dma_scanline_count++;
       if (dma_scanline_count == dma_n_scanlines) {
-        dma_writes++;
-        if (display.dmaBusy()) {
-          dma_busy++;
-        }
-        display.pushPixelsDMA(dma_buf,
-                              uint32_t(display_width * dma_n_scanlines));
+        // continue rendering in the next buffer of the ring
+        dma_buf = render_buf_ptr =
+            render_band_end(dma_buf, dma_n_scanlines, partial, band_paint);
         dma_scanline_count = 0;
-        // swap to the other render buffer
-        dma_buf = render_buf_ptr = dma_buf_use_first ? dma_buf_1 : dma_buf_2;
-        dma_buf_use_first = !dma_buf_use_first;
       }
     }
     tile_y++;
     remaining_y -= render_n_scanlines;
-    tiles_map_row_ptr += tile_map_width;
+    tiles_map_row_ptr = tile_map.row(tile_y);
   }
   // if 'display_height' is not evenly divisible by 'dma_n_scanlines' there will
   // be remaining scanlines to write
-  constexpr int dma_n_scanlines_trailing = display_height % dma_n_scanlines;
+  const int dma_n_scanlines_trailing = display_height % dma_n_scanlines;
   if (dma_n_scanlines_trailing) {
-    dma_writes++;
-    if (display.dmaBusy()) {
-      dma_busy++;
-    }
-    display.pushPixelsDMA(dma_buf,
-                          uint32_t(display_width * dma_n_scanlines_trailing));
+    render_band_end(dma_buf, dma_n_scanlines_trailing, partial, band_paint);
   }
 }
@@ -10,6 +10,7 @@
 //   object hierarchy or 0 if 'Type' sizeof is used
 //
 // note. no destructor since life-time is program life-time
+// note. keeps statistics of usage for sizing the store
 //
 
 // reviewed: 2024-05-01
@@ -26,6 +27,12 @@ class o1store {
   Type **del_bgn_ = nullptr;
   Type **del_ptr_ = nullptr;
   Type **del_end_ = nullptr;
+  // statistics
+  int peak_allocated_ = 0;
+  int freed_last_apply_ = 0;
+  uint32_t allocations_ = 0;
+  uint32_t frees_ = 0;
+  uint32_t failed_allocations_ = 0;
 
 public:
   o1store() {
@@ -64,6 +71,7 @@ public:
   // returns nullptr if instance could not be allocated
   auto allocate_instance() -> Type * {
     if (free_ptr_ >= free_end_) {
+      failed_allocations_++;
       return nullptr;
     }
     Type *inst = *free_ptr_;
@@ -71,6 +79,11 @@ public:
     *alloc_ptr_ = inst;
     inst->alloc_ptr = alloc_ptr_;
     alloc_ptr_++;
+    allocations_++;
+    const int len = alloc_ptr_ - alloc_bgn_;
+    if (len > peak_allocated_) {
+      peak_allocated_ = len;
+    }
     return inst;
   }
 
@@ -95,6 +108,8 @@ public:
       free_ptr_--;
       *free_ptr_ = inst_deleted;
     }
+    freed_last_apply_ = del_ptr_ - del_bgn_;
+    frees_ += uint32_t(freed_last_apply_);
     del_ptr_ = del_bgn_;
   }
 
@@ -125,6 +140,23 @@ public:
                                     InstanceSizeInBytes * ix);
   }
 
+  // returns maximum length of allocated instances list since start
+  inline auto peak_allocated() const -> int { return peak_allocated_; }
+
+  // returns number of instances deallocated by last 'apply_free()'
+  inline auto freed_last_apply() const -> int { return freed_last_apply_; }
+
+  // returns number of allocations since start
+  inline auto allocations() const -> uint32_t { return allocations_; }
+
+  // returns number of deallocations since start
+  inline auto frees() const -> uint32_t { return frees_; }
+
+  // returns number of times 'allocate_instance()' returned nullptr since start
+  inline auto failed_allocations() const -> uint32_t {
+    return failed_allocations_;
+  }
+
   // returns the size of allocated heap memory in bytes
   constexpr auto allocated_data_size_B() const -> int {
     return InstanceSizeInBytes
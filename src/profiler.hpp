@@ -0,0 +1,213 @@
+#pragma once
+//
+// profiler of the phases of a frame
+//
+// * time spent in zones of a frame is summed during the frame with
+//   'profiler_scope' and added to the statistics of each zone at
+//   'frame_end()'
+// * statistics are min, average, max and 99th percentile from a histogram
+//   with 4 buckets per power of 2, precision is 1/4 of the value
+// * ticks are cpu cycles read from register 'ccount' on device and nano
+//   seconds from a steady clock on host
+//
+// note. enabled by 'profiler_enabled' in 'defs.hpp'
+//
+
+#include "game/defs.hpp"
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#ifndef __XTENSA__
+#include <chrono>
+#endif
+
+// returns current ticks, wraps around
+static inline auto profiler_ticks() -> uint32_t {
+#ifdef __XTENSA__
+  uint32_t ccount;
+  __asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+  return ccount;
+#else
+  return uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch())
+                      .count());
+#endif
+}
+
+// zones of a frame
+// note. 'prof_frame' is the time between frames and zones in 'render' are
+//       included in 'render'
+enum profiler_zone : uint8_t {
+  prof_frame,
+  prof_touch,
+  prof_pre_render,
+  prof_collisions,
+  prof_tile_map,
+  prof_render,
+  prof_render_tiles,
+  prof_render_sprites,
+  prof_render_collisions,
+  prof_dma_wait,
+  prof_dispatch,
+  prof_update,
+  prof_apply_free,
+  prof_frame_completed,
+  prof_zones_count
+};
+
+class profiler {
+  static constexpr int buckets_count = 128;
+
+  struct zone_stats {
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t count;
+    uint16_t buckets[buckets_count];
+  };
+
+  static constexpr char const *zone_names[prof_zones_count]{
+      "frame",          "touch",         "pre_render",    "collisions",
+      "tile_map",       "render",        "render_tiles",  "render_sprites",
+      "render_collide", "dma_wait",      "dispatch",      "update",
+      "apply_free",     "frame_complete"};
+
+  // ticks of zones in current frame
+  uint32_t frame_[prof_zones_count]{};
+  // ticks at end of previous frame
+  uint32_t frame_end_ticks_ = 0;
+  // true if 'frame_end_ticks_' is set
+  bool frame_ended_ = false;
+  zone_stats stats_[prof_zones_count];
+
+  // returns index of histogram bucket for 'ticks'
+  static auto bucket(const uint32_t ticks) -> int {
+    if (ticks < 4) {
+      return int(ticks);
+    }
+    const int msb = 31 - __builtin_clz(ticks);
+    return ((msb - 1) << 2) + int((ticks >> (msb - 2)) & 3);
+  }
+
+  // returns largest ticks in bucket 'ix'
+  static auto bucket_max(const int ix) -> uint32_t {
+    if (ix < 4) {
+      return uint32_t(ix);
+    }
+    const int shift = (ix >> 2) - 1;
+    return (uint32_t(4 + (ix & 3)) << shift) + (uint32_t(1) << shift) - 1;
+  }
+
+  // returns ticks at 'percent' percentile of 'st' rounded up to bucket
+  static auto percentile(zone_stats const &st, const int percent) -> uint32_t {
+    const uint32_t n = (st.count * uint32_t(percent) + 99) / 100;
+    uint32_t sum = 0;
+    for (int i = 0; i < buckets_count; i++) {
+      sum += st.buckets[i];
+      if (sum >= n) {
+        const uint32_t max = bucket_max(i);
+        return max < st.max ? max : st.max;
+      }
+    }
+    return st.max;
+  }
+
+public:
+  profiler() { reset(); }
+
+  // clears statistics
+  void reset() {
+    for (zone_stats &st : stats_) {
+      st.min = UINT32_MAX;
+      st.max = 0;
+      st.sum = 0;
+      st.count = 0;
+      memset(st.buckets, 0, sizeof(st.buckets));
+    }
+  }
+
+  // adds 'ticks' to 'zone' in current frame
+  inline void add(const profiler_zone zone, const uint32_t ticks) {
+    frame_[zone] += ticks;
+  }
+
+  // adds the ticks of zones in current frame to the statistics
+  // note. zone 'prof_frame' is the ticks since previous call
+  void frame_end() {
+    const uint32_t now = profiler_ticks();
+    frame_[prof_frame] = now - frame_end_ticks_;
+    frame_end_ticks_ = now;
+    if (!frame_ended_) {
+      // first frame has no beginning
+      frame_ended_ = true;
+      memset(frame_, 0, sizeof(frame_));
+      return;
+    }
+    for (int i = 0; i < prof_zones_count; i++) {
+      const uint32_t ticks = frame_[i];
+      frame_[i] = 0;
+      zone_stats &st = stats_[i];
+      st.min = ticks < st.min ? ticks : st.min;
+      st.max = ticks > st.max ? ticks : st.max;
+      st.sum += ticks;
+      st.count++;
+      uint16_t &bucket_count = st.buckets[bucket(ticks)];
+      if (bucket_count < UINT16_MAX) {
+        bucket_count++;
+      }
+    }
+  }
+
+  // prints statistics of frames since last report in micro seconds and
+  // resets them
+  void report(const uint32_t ticks_per_us) {
+    printf("%-16s %8s %8s %8s %8s\n", "zone (us)", "min", "avg", "p99",
+           "max");
+    for (int i = 0; i < prof_zones_count; i++) {
+      zone_stats const &st = stats_[i];
+      if (!st.count) {
+        continue;
+      }
+      printf("%-16s %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 "\n",
+             zone_names[i], st.min / ticks_per_us,
+             uint32_t(st.sum / st.count / ticks_per_us),
+             percentile(st, 99) / ticks_per_us, st.max / ticks_per_us);
+    }
+    reset();
+  }
+} static profiler{};
+
+// out of class definition of constexpr array
+// note. C++11 requires it when the array is indexed
+constexpr char const *profiler::zone_names[prof_zones_count];
+
+// adds the ticks from construction to destruction to 'zone' of current frame
+// if 'profiler_enabled'
+// note. 'next(...)' adds ticks so far and continues with another zone for
+//       consecutive phases in the same scope
+class profiler_scope {
+  profiler_zone zone_;
+  uint32_t begin_;
+
+public:
+  inline explicit profiler_scope(const profiler_zone zone)
+      : zone_{zone}, begin_{profiler_enabled ? profiler_ticks() : 0} {}
+
+  inline ~profiler_scope() {
+    if (profiler_enabled) {
+      profiler.add(zone_, profiler_ticks() - begin_);
+    }
+  }
+
+  inline void next(const profiler_zone zone) {
+    if (profiler_enabled) {
+      const uint32_t now = profiler_ticks();
+      profiler.add(zone_, now - begin_);
+      zone_ = zone;
+      begin_ = now;
+    }
+  }
+};
@@ -0,0 +1,129 @@
+#pragma once
+//
+// binary telemetry records written to a lock-free ring buffer by the game
+// loop and read by another task that writes them to the serial port
+//
+// record format (little endian):
+// * uint8_t 'telemetry_sync'
+// * uint8_t type, see 'telemetry_type'
+// * uint8_t payload size in bytes
+// * payload, one of the 'telemetry_*' structs
+// * uint8_t checksum: sum of type, size and payload bytes
+//
+// note. decoded by 'etc/telemetry-decode.py'
+// note. enabled by 'telemetry_enabled' in 'defs.hpp'
+//
+
+#include <atomic>
+#include <cstdint>
+
+static constexpr uint8_t telemetry_sync = 0xa5;
+
+enum telemetry_type : uint8_t {
+  telemetry_type_frame = 1,
+  telemetry_type_status = 2,
+  telemetry_type_stores = 3
+};
+
+// written every frame
+struct telemetry_frame {
+  uint32_t ms;        // time of frame
+  uint32_t frame_us;  // time since previous frame
+  uint32_t engine_us; // time in 'engine_loop()'
+  uint16_t objects;   // allocated objects
+  uint16_t sprites;   // allocated sprites
+  uint16_t dma_writes;
+  uint16_t dma_busy; // writes when DMA was busy with previous transfer
+  uint16_t objects_freed;
+  uint16_t sprites_freed;
+};
+static_assert(sizeof(telemetry_frame) == 24, "no padding");
+
+// written at fps update
+struct telemetry_status {
+  uint32_t ms;
+  uint32_t free_heap_B;
+  uint32_t dropped; // records dropped due to full ring buffer
+  uint16_t fps;
+  uint16_t ldr; // light dependent resistor reading
+};
+static_assert(sizeof(telemetry_status) == 16, "no padding");
+
+// usage of object and sprite stores since start, written at fps update
+struct telemetry_stores {
+  uint32_t ms;
+  uint32_t objects_allocations;
+  uint32_t objects_failed; // allocations that returned nullptr
+  uint32_t sprites_allocations;
+  uint32_t sprites_failed;
+  uint16_t objects_peak; // maximum number of allocated objects
+  uint16_t sprites_peak;
+};
+static_assert(sizeof(telemetry_stores) == 24, "no padding");
+
+// single producer single consumer ring buffer of records
+// 'SizeB' must be a power of 2
+template <const int SizeB> class telemetry_ring {
+  static_assert(SizeB && !(SizeB & (SizeB - 1)), "size must be power of 2");
+  static constexpr uint32_t mask = SizeB - 1;
+
+  uint8_t buf_[SizeB]{};
+  // written by producer
+  std::atomic<uint32_t> head_{0};
+  // written by consumer
+  std::atomic<uint32_t> tail_{0};
+  uint32_t dropped_ = 0;
+
+  inline void put(const uint32_t pos, const uint8_t byte) {
+    buf_[pos & mask] = byte;
+  }
+
+public:
+  // writes record of 'type' with 'payload'
+  // returns false if the ring buffer is full and the record was dropped
+  template <typename T>
+  auto write(const telemetry_type type, T const &payload) -> bool {
+    static_assert(sizeof(T) <= 255, "payload size must fit in a byte");
+    constexpr uint32_t record_size_B = 4 + sizeof(T);
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    const uint32_t tail = tail_.load(std::memory_order_acquire);
+    if (SizeB - (head - tail) < record_size_B) {
+      dropped_++;
+      return false;
+    }
+    uint8_t const *src = reinterpret_cast<uint8_t const *>(&payload);
+    uint8_t sum = uint8_t(type + sizeof(T));
+    put(head++, telemetry_sync);
+    put(head++, type);
+    put(head++, uint8_t(sizeof(T)));
+    for (uint32_t i = 0; i < sizeof(T); i++) {
+      sum = uint8_t(sum + src[i]);
+      put(head++, src[i]);
+    }
+    put(head++, sum);
+    head_.store(head, std::memory_order_release);
+    return true;
+  }
+
+  // returns number of records dropped since start
+  // note. called by producer
+  auto dropped() const -> uint32_t { return dropped_; }
+
+  // returns contiguous bytes that can be read and sets 'size_B'
+  // note. called by consumer
+  auto peek(int &size_B) const -> uint8_t const * {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    const uint32_t to_end = SizeB - (tail & mask);
+    const uint32_t n = head - tail;
+    size_B = int(n < to_end ? n : to_end);
+    return buf_ + (tail & mask);
+  }
+
+  // releases 'size_B' bytes that have been read
+  // note. called by consumer
+  void consume(const int size_B) {
+    tail_.store(tail_.load(std::memory_order_relaxed) + uint32_t(size_B),
+                std::memory_order_release);
+  }
+};
@@ -0,0 +1,352 @@
+#pragma once
+//
+// implements a tile map where only a window of rows is kept in memory
+//
+// * rows are decoded on demand from a run-length encoded source
+// * ring buffer of 'Rows' rows where map row 'r' is kept at 'r % Rows'
+// * 'update(...)' loads the visible rows and a margin of rows around them
+// * optionally the margin is loaded by 'prefetch()' called from another task
+//   and 'update(...)' only loads visible rows that have not been prefetched
+//
+// run-length encoded format (see 'game/png-to-resources/compress-tile-map.py'):
+// * each row is a sequence of pairs {count, tile index} expanding to 'Width'
+//   tiles
+// * offsets to the start of each row plus the end offset enables decoding of
+//   any row independently of the others
+//
+// binary file format (little endian):
+// * uint32 width, uint32 height
+// * uint32 offsets[height + 1] in number of 'TileIx'
+// * TileIx data[offsets[height]]
+//
+// note. no destructor since life-time is program life-time
+//
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+// decodes run-length encoded row from 'src' into 'dst'
+// returns false if data is corrupt or a tile index is not less than
+// 'tiles_count'
+template <typename TileIx, const int Width>
+static auto tile_map_decode_row(TileIx const *src, TileIx const *src_end,
+                                TileIx *dst, const uint32_t tiles_count)
+    -> bool {
+  TileIx *const dst_end = dst + Width;
+  while (dst < dst_end) {
+    if (src_end - src < 2) {
+      return false;
+    }
+    int count = *src++;
+    const TileIx tile = *src++;
+    if (count == 0 || dst + count > dst_end || tile >= tiles_count) {
+      return false;
+    }
+    while (count--) {
+      *dst++ = tile;
+    }
+  }
+  return true;
+}
+
+// interface of a source of tile map rows
+template <typename TileIx, const int Width> class tile_map_source {
+public:
+  virtual ~tile_map_source() {}
+
+  // returns number of rows in the map
+  virtual auto height() const -> int = 0;
+
+  // decodes 'row' into 'dst' that has room for 'Width' tiles
+  // returns false if row could not be read
+  virtual auto read_row(int row, TileIx *dst) -> bool = 0;
+};
+
+// run-length encoded tile map in program memory
+template <typename TileIx, const int Width>
+class tile_map_source_rle final : public tile_map_source<TileIx, Width> {
+  TileIx const *data_ = nullptr;
+  uint32_t const *row_offsets_ = nullptr;
+  int height_ = 0;
+  uint32_t tiles_count_ = 0;
+
+public:
+  tile_map_source_rle(TileIx const *data, uint32_t const *row_offsets,
+                      const int height, const int tiles_count)
+      : data_{data}, row_offsets_{row_offsets}, height_{height},
+        tiles_count_{uint32_t(tiles_count)} {}
+
+  auto height() const -> int override { return height_; }
+
+  auto read_row(const int row, TileIx *dst) -> bool override {
+    if (row < 0 || row >= height_) {
+      return false;
+    }
+    return tile_map_decode_row<TileIx, Width>(data_ + row_offsets_[row],
+                                              data_ + row_offsets_[row + 1],
+                                              dst, tiles_count_);
+  }
+};
+
+// run-length encoded tile map in a file
+// note. the file is kept open and rows are read when requested
+template <typename TileIx, const int Width>
+class tile_map_source_file final : public tile_map_source<TileIx, Width> {
+  FILE *file_ = nullptr;
+  long offset_ = 0;
+  int height_ = 0;
+  uint32_t tiles_count_ = 0;
+
+public:
+  // opens tile map at 'offset' in file 'path' with tile indexes less than
+  // 'tiles_count'
+  // returns false if file could not be opened or has unexpected width
+  auto open(const char *path, const long offset, const int tiles_count)
+      -> bool {
+    close();
+    file_ = fopen(path, "rb");
+    if (!file_) {
+      return false;
+    }
+    uint32_t header[2]{};
+    if (fseek(file_, offset, SEEK_SET) ||
+        fread(header, sizeof(header), 1, file_) != 1 || header[0] != Width) {
+      close();
+      return false;
+    }
+    offset_ = offset;
+    height_ = int(header[1]);
+    tiles_count_ = uint32_t(tiles_count);
+    return true;
+  }
+
+  void close() {
+    if (file_) {
+      fclose(file_);
+      file_ = nullptr;
+    }
+    height_ = 0;
+  }
+
+  auto is_open() const -> bool { return file_ != nullptr; }
+
+  auto height() const -> int override { return height_; }
+
+  // returns false if any row could not be read
+  // note. reads the whole map, used when loading to reject corrupt files
+  auto validate() -> bool {
+    TileIx row[Width];
+    for (int i = 0; i < height_; i++) {
+      if (!read_row(i, row)) {
+        printf("!!! tile_map_source_file: row %d is corrupt\n", i);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  auto read_row(const int row, TileIx *dst) -> bool override {
+    if (!file_ || row < 0 || row >= height_) {
+      return false;
+    }
+    // read offset of row and next row
+    uint32_t offsets[2]{};
+    const long offsets_pos =
+        offset_ + long(2 * sizeof(uint32_t) + sizeof(uint32_t) * row);
+    if (fseek(file_, offsets_pos, SEEK_SET) ||
+        fread(offsets, sizeof(offsets), 1, file_) != 1) {
+      return false;
+    }
+    // a row is at most 'Width' pairs
+    const uint32_t len = offsets[1] - offsets[0];
+    if (offsets[1] < offsets[0] || len > uint32_t(2 * Width)) {
+      return false;
+    }
+    TileIx buf[2 * Width];
+    const long data_pos = offset_ +
+                          long(sizeof(uint32_t) * (2 + height_ + 1)) +
+                          long(sizeof(TileIx) * offsets[0]);
+    if (fseek(file_, data_pos, SEEK_SET) ||
+        fread(buf, sizeof(TileIx), len, file_) != len) {
+      return false;
+    }
+    return tile_map_decode_row<TileIx, Width>(buf, buf + len, dst,
+                                              tiles_count_);
+  }
+};
+
+template <typename TileIx, const int Width, const int Rows>
+class tile_map_stream {
+  TileIx rows_[Rows][Width]{};
+  // map row held by ring buffer slot or -1 if none
+  int rows_ix_[Rows];
+  tile_map_source<TileIx, Width> *src_ = nullptr;
+  // rows requested by last 'update(...)'
+  int first_row_ = 0;
+  int visible_rows_ = 0;
+  bool prefetch_ = false;
+  // incremented when source is set, discards rows read by 'prefetch()' from
+  // previous source
+  uint32_t source_gen_ = 0;
+  // row read by 'prefetch()' before it is published to its slot
+  TileIx prefetch_row_[Width]{};
+  // note. guards slots, requested rows and source between 'update(...)' and
+  //       'prefetch()'
+  //       rendering reads the visible rows without the lock since 'prefetch()'
+  //       only writes to slots of rows in the margin
+  std::mutex mutex_;
+  // note. serializes reads from source, taken after 'mutex_' or alone by
+  //       'prefetch()' while reading so that 'update(...)' is not blocked by
+  //       file reads of rows in the margin
+  std::mutex source_mutex_;
+
+  // reads 'row' from source into 'dst' or zeros if it could not be read
+  static void read(tile_map_source<TileIx, Width> *src, const int row,
+                   TileIx *dst) {
+    if (!src->read_row(row, dst)) {
+      printf("!!! tile_map_stream: could not read row %d\n", row);
+      memset(dst, 0, sizeof(TileIx) * Width);
+    }
+  }
+
+  // loads 'row' into its slot if not already loaded
+  // note. called with 'mutex_' held
+  void load(const int row) {
+    const int slot = row % Rows;
+    if (rows_ix_[slot] == row) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock{source_mutex_};
+      read(src_, row, rows_[slot]);
+    }
+    rows_ix_[slot] = row;
+  }
+
+  // returns true if 'row' is in the margin around the visible rows
+  // note. called with 'mutex_' held
+  auto in_margin(const int row) const -> bool {
+    const int margin = (Rows - visible_rows_) / 2;
+    return (row >= first_row_ - margin && row < first_row_) ||
+           (row >= first_row_ + visible_rows_ &&
+            row < first_row_ + visible_rows_ + margin);
+  }
+
+  // returns a row in the margin that is not loaded, nearest to visible rows
+  // first, or -1 if all are loaded
+  // note. called with 'mutex_' held
+  auto next_prefetch_row() const -> int {
+    const int margin = (Rows - visible_rows_) / 2;
+    const int height = src_->height();
+    for (int i = 1; i <= margin; i++) {
+      const int above = first_row_ - i;
+      if (above >= 0 && rows_ix_[above % Rows] != above) {
+        return above;
+      }
+      const int below = first_row_ + visible_rows_ - 1 + i;
+      if (below < height && rows_ix_[below % Rows] != below) {
+        return below;
+      }
+    }
+    return -1;
+  }
+
+public:
+  tile_map_stream() {
+    for (int i = 0; i < Rows; i++) {
+      rows_ix_[i] = -1;
+    }
+  }
+
+  // sets the source of rows and discards loaded rows
+  void set_source(tile_map_source<TileIx, Width> *src) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    std::lock_guard<std::mutex> source_lock{source_mutex_};
+    src_ = src;
+    source_gen_++;
+    for (int i = 0; i < Rows; i++) {
+      rows_ix_[i] = -1;
+    }
+  }
+
+  // if enabled the margin is loaded by calls to 'prefetch()' instead of
+  // 'update(...)'
+  void set_prefetch(const bool enabled) { prefetch_ = enabled; }
+
+  // returns number of rows in the map
+  auto height() const -> int { return src_ ? src_->height() : 0; }
+
+  // loads rows 'first_row' to 'first_row + visible_rows' and the rows in the
+  // margin around them unless prefetch is enabled
+  // note. only rows not already in the buffer are decoded
+  void update(const int first_row, const int visible_rows) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    first_row_ = first_row;
+    visible_rows_ = visible_rows;
+    if (!src_) {
+      return;
+    }
+    const int margin = prefetch_ ? 0 : (Rows - visible_rows) / 2;
+    int bgn = first_row - margin;
+    int end = first_row + visible_rows + margin;
+    if (bgn < 0) {
+      bgn = 0;
+    }
+    if (end > src_->height()) {
+      end = src_->height();
+    }
+    for (int row = bgn; row < end; row++) {
+      load(row);
+    }
+  }
+
+  // loads one row in the margin, nearest to visible rows first
+  // returns false if all rows in the margin are loaded
+  // note. the row is read without holding the lock used by 'update(...)' and
+  //       published to its slot if it is still in the margin
+  auto prefetch() -> bool {
+    int row = -1;
+    uint32_t gen = 0;
+    tile_map_source<TileIx, Width> *src = nullptr;
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      if (!src_) {
+        return false;
+      }
+      row = next_prefetch_row();
+      if (row == -1) {
+        return false;
+      }
+      gen = source_gen_;
+      src = src_;
+    }
+    {
+      std::lock_guard<std::mutex> source_lock{source_mutex_};
+      if (gen != source_gen_) {
+        // source changed since row was selected
+        return true;
+      }
+      read(src, row, prefetch_row_);
+    }
+    std::lock_guard<std::mutex> lock{mutex_};
+    const int slot = row % Rows;
+    if (gen == source_gen_ && rows_ix_[slot] != row && in_margin(row)) {
+      memcpy(rows_[slot], prefetch_row_, sizeof(rows_[slot]));
+      rows_ix_[slot] = row;
+    }
+    return true;
+  }
+
+  // returns true if row 'ix' is in the visible rows of the last 'update(...)'
+  // note. visible rows are not written by 'prefetch()'
+  inline auto is_visible(const int ix) const -> bool {
+    return ix >= first_row_ && ix < first_row_ + visible_rows_;
+  }
+
+  // returns pointer to 'Width' tiles of row 'ix'
+  // note. row must be in the window of the last 'update(...)'
+  // note. rows may be modified but changes are lost when row is evicted
+  inline auto row(const int ix) -> TileIx * { return rows_[ix % Rows]; }
+};
@@ -0,0 +1,75 @@
+#pragma once
+// emulation of the parts of the Arduino core and ESP-IDF used by the engine
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+#define MALLOC_CAP_DMA 1
+#define MALLOC_CAP_DEFAULT 2
+#define MALLOC_CAP_INTERNAL 4
+#define MALLOC_CAP_8BIT 8
+
+#define pdTRUE 1
+#define portMAX_DELAY 0xffffffff
+
+// milliseconds since start, advanced by the emulator every frame
+extern uint32_t emulator_millis;
+
+// console input, consumed by 'Serial.read()'
+extern char const *emulator_serial_in;
+
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+inline auto analogRead(int) -> uint16_t { return 0; }
+inline void delay(uint32_t) {}
+inline auto millis() -> uint32_t { return emulator_millis; }
+inline auto micros() -> uint32_t { return emulator_millis * 1000; }
+inline auto xthal_get_ccount() -> uint32_t { return 0; }
+
+class SerialClass {
+public:
+  void begin(int) {}
+  auto available() -> int {
+    return emulator_serial_in && *emulator_serial_in;
+  }
+  auto read() -> int { return *emulator_serial_in++; }
+  auto write(uint8_t const *, const size_t n) -> size_t { return n; }
+} static Serial;
+
+class EspClass {
+public:
+  auto getChipModel() -> char const * { return "emulator"; }
+  auto getChipRevision() -> unsigned { return 0; }
+  auto getChipCores() -> unsigned { return 2; }
+  auto getCpuFreqMHz() -> unsigned { return 240; }
+  auto getFreeHeap() -> unsigned { return 1 << 20; }
+  auto getMaxAllocHeap() -> unsigned { return 0; }
+} static ESP;
+
+inline auto heap_caps_calloc(const size_t n, const size_t size, int)
+    -> void * {
+  return calloc(n, size);
+}
+inline auto heap_caps_malloc(const size_t size, int) -> void * {
+  return malloc(size);
+}
+inline void heap_caps_print_heap_info(int) {}
+
+// note. tasks are not created
+typedef void (*TaskFunction_t)(void *);
+inline auto xTaskCreatePinnedToCore(TaskFunction_t, char const *, int, void *,
+                                    int, void *, int) -> int {
+  return 1;
+}
+inline auto xTaskGetCurrentTaskHandle() -> void * { return nullptr; }
+inline void vTaskDelay(int) {}
+// note. DMA transfers are done when queued
+inline auto ulTaskNotifyTake(int, uint32_t) -> uint32_t { return 1; }
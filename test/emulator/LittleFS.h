@@ -0,0 +1,8 @@
+#pragma once
+// emulation without a file system, the asset pack is not loaded
+
+class LittleFSClass {
+public:
+  auto begin(bool = false) -> bool { return false; }
+  auto exists(char const *) -> bool { return false; }
+} static LittleFS;
@@ -0,0 +1,9 @@
+#pragma once
+
+#define HSPI 2
+
+class SPIClass {
+public:
+  SPIClass(int) {}
+  void begin(int, int, int, int) {}
+};
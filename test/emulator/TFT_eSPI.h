@@ -0,0 +1,82 @@
+#pragma once
+// emulation of the display written to a frame buffer
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// display pixels in the orientation set by 'setRotation(...)'
+extern uint16_t emulator_frame_buffer[TFT_WIDTH * TFT_HEIGHT];
+
+class TFT_eSPI {
+  int width_ = TFT_WIDTH;
+  int height_ = TFT_HEIGHT;
+  int window_x_ = 0;
+  int window_y_ = 0;
+  int window_width_ = TFT_WIDTH;
+  int window_height_ = TFT_HEIGHT;
+  int x_ = 0;
+  int y_ = 0;
+  bool bus_held_ = false;
+
+public:
+  bool DMA_Enabled = false;
+
+  void init() {}
+
+  void setRotation(const uint8_t r) {
+    width_ = r & 1 ? TFT_HEIGHT : TFT_WIDTH;
+    height_ = r & 1 ? TFT_WIDTH : TFT_HEIGHT;
+  }
+
+  void setAddrWindow(const int32_t x, const int32_t y, const int32_t w,
+                     const int32_t h) {
+    if (bus_held_) {
+      // note. not possible on the device, see 'dmaHoldBus' in 'TFT_eSPI.h'
+      fprintf(stderr, "!!! setAddrWindow while DMA holds the bus\n");
+      exit(1);
+    }
+    if (x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > width_ ||
+        y + h > height_) {
+      fprintf(stderr, "!!! setAddrWindow(%d, %d, %d, %d) outside display\n",
+              int(x), int(y), int(w), int(h));
+      exit(1);
+    }
+    window_x_ = x;
+    window_y_ = y;
+    window_width_ = w;
+    window_height_ = h;
+    x_ = 0;
+    y_ = 0;
+  }
+
+  auto initDMA(bool = false) -> bool {
+    DMA_Enabled = true;
+    return true;
+  }
+
+  void pushPixelsDMAQueued(uint16_t const *image, const uint32_t len) {
+    if (!DMA_Enabled) {
+      fprintf(stderr, "!!! pushPixelsDMAQueued without DMA\n");
+      exit(1);
+    }
+    for (uint32_t i = 0; i < len; i++) {
+      emulator_frame_buffer[(window_y_ + y_) * width_ + window_x_ + x_] =
+          image[i];
+      x_++;
+      if (x_ == window_width_) {
+        x_ = 0;
+        y_++;
+        if (y_ == window_height_) {
+          y_ = 0;
+        }
+      }
+    }
+  }
+
+  // note. transfers are done when queued
+  auto dmaQueued() -> uint8_t { return 0; }
+  void dmaWaitQueued(uint8_t) {}
+  void dmaSetNotifyTask(void *) {}
+  void dmaHoldBus(const bool hold) { bus_held_ = DMA_Enabled && hold; }
+};
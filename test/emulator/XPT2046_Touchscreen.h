@@ -0,0 +1,25 @@
+#pragma once
+// emulation of a touch screen that is pressed at varying x
+
+#include <SPI.h>
+
+struct TS_Point {
+  int16_t x;
+  int16_t y;
+  int16_t z;
+};
+
+class XPT2046_Touchscreen {
+  int reads_ = 0;
+
+public:
+  XPT2046_Touchscreen(int, int) {}
+  void begin(SPIClass &) {}
+  void setRotation(int) {}
+  auto tirqTouched() -> bool { return true; }
+  auto touched() -> bool { return true; }
+  auto getPoint() -> TS_Point {
+    reads_++;
+    return {int16_t(500 + reads_ * 37 % 3200), 2000, 500};
+  }
+};
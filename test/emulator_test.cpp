@@ -0,0 +1,84 @@
+//
+// host emulation of the device running 'src/main.cpp'
+//
+// * display, touch screen, serial console and platform are emulated by the
+//   headers in 'emulator/'
+// * every frame advances the time by 'frame_ms' and writes a hash of the
+//   display to the hashes file, one line per frame
+// * console commands are given at frames, e.g. '0 "set partial 0"'
+// * command 'tile <tile x> <row on screen> <tile>' sets a tile in the tile map
+//   with 'tile_map_set(...)' before the frame, e.g. '200 "tile 3 5 1"'
+// * writing the display window while DMA holds the bus fails the run
+//
+// usage: emulator_test <frames> <hashes file> [<frame> <command>]...
+// note. built and run by 'Makefile' that compares the hashes of runs
+//
+
+#include "main.cpp"
+
+uint32_t emulator_millis = 0;
+char const *emulator_serial_in = nullptr;
+uint16_t emulator_frame_buffer[TFT_WIDTH * TFT_HEIGHT];
+
+static constexpr uint32_t frame_ms = 32;
+
+// sets a tile from emulator command 'tile <tile x> <row on screen> <tile>'
+// returns false if the command is not 'tile' or the tile could not be set
+static auto tile_command(char const *cmd) -> bool {
+  int tile_x = 0;
+  int row = 0;
+  int t = 0;
+  if (sscanf(cmd, "tile %d %d %d", &tile_x, &row, &t) != 3) {
+    return false;
+  }
+  if (!tile_map_set(tile_x, int(tile_map_y) / tile_height + row,
+                    tile_ix(t))) {
+    printf("!!! could not set tile at %d, %d on screen\n", tile_x, row);
+  }
+  return true;
+}
+
+// FNV-1a hash of the display
+static auto frame_buffer_hash() -> uint64_t {
+  uint64_t hash = 14695981039346656037ull;
+  for (const uint16_t pixel : emulator_frame_buffer) {
+    hash = (hash ^ pixel) * 1099511628211ull;
+  }
+  return hash;
+}
+
+int main(const int argc, char **argv) {
+  if (argc < 3 || argc % 2 == 0) {
+    printf("usage: %s <frames> <hashes file> [<frame> <command>]...\n",
+           argv[0]);
+    return 1;
+  }
+  const int frames = atoi(argv[1]);
+  FILE *hashes = fopen(argv[2], "w");
+  if (!hashes) {
+    printf("!!! could not open '%s'\n", argv[2]);
+    return 1;
+  }
+
+  // console input of current frame
+  static char commands[256];
+
+  setup();
+  for (int frame = 0; frame < frames; frame++) {
+    commands[0] = '\0';
+    for (int i = 3; i < argc; i += 2) {
+      if (atoi(argv[i]) != frame || tile_command(argv[i + 1])) {
+        continue;
+      }
+      const size_t len = strlen(commands);
+      snprintf(commands + len, sizeof(commands) - len, "%s\n", argv[i + 1]);
+    }
+    emulator_serial_in = commands;
+    emulator_millis += frame_ms;
+    loop();
+    fprintf(hashes, "%d %016llx\n", frame,
+            static_cast<unsigned long long>(frame_buffer_hash()));
+  }
+  fclose(hashes);
+  return 0;
+}
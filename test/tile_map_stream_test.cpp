@@ -0,0 +1,346 @@
+//
+// host test of 'tile_map_stream.hpp'
+//
+// * round trip of the tile map compressed by 'compress-tile-map.py' from
+//   program memory and from a file
+// * corrupt offsets and row lengths are rejected
+// * prefetch loads the margin around the visible rows, nearest first
+// * rows stay intact while prefetch runs on another thread during scrolling
+//
+// usage: tile_map_stream_test <tile map .bin written by compress-tile-map.py>
+// note. built and run by 'Makefile'
+//
+
+#include "../src/tile_map_stream.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using tile_ix = uint8_t;
+static constexpr int width = 15;
+static constexpr int rows = 25;
+static constexpr int visible_rows = 21;
+static constexpr int margin = (rows - visible_rows) / 2;
+static constexpr int tiles_count = 256;
+
+// tile map as edited
+static constexpr tile_ix tile_map[][width]{
+#include "../src/game/resources/tile_map.hpp"
+};
+static constexpr int height = sizeof(tile_map) / sizeof(tile_map[0]);
+
+// output of 'compress-tile-map.py'
+static constexpr tile_ix tile_map_rle[]{
+#include "tile_map_rle.hpp"
+};
+static constexpr uint32_t tile_map_rle_rows[height + 1]{
+#include "tile_map_rle_rows.hpp"
+};
+
+static int failures = 0;
+
+#define expect(cond)                                                           \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #cond);                \
+      failures++;                                                              \
+    }                                                                          \
+  } while (false)
+
+// source that records the rows read from another source
+class recording_source final : public tile_map_source<tile_ix, width> {
+  tile_map_source<tile_ix, width> *src_;
+
+public:
+  std::vector<int> reads;
+
+  explicit recording_source(tile_map_source<tile_ix, width> *src)
+      : src_{src} {}
+
+  auto height() const -> int override { return src_->height(); }
+
+  auto read_row(const int row, tile_ix *dst) -> bool override {
+    reads.push_back(row);
+    return src_->read_row(row, dst);
+  }
+};
+
+static auto read_file(char const *path) -> std::vector<uint8_t> {
+  std::vector<uint8_t> data;
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    return data;
+  }
+  uint8_t buf[4096];
+  size_t n = 0;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+    data.insert(data.end(), buf, buf + n);
+  }
+  fclose(f);
+  return data;
+}
+
+static void write_file(char const *path, std::vector<uint8_t> const &data) {
+  FILE *f = fopen(path, "wb");
+  fwrite(data.data(), 1, data.size(), f);
+  fclose(f);
+}
+
+static auto offset_pos(const int row) -> size_t {
+  return sizeof(uint32_t) * size_t(2 + row);
+}
+
+static auto get_u32(std::vector<uint8_t> const &data, const size_t pos)
+    -> uint32_t {
+  uint32_t v = 0;
+  memcpy(&v, &data[pos], sizeof(v));
+  return v;
+}
+
+static void set_u32(std::vector<uint8_t> &data, const size_t pos,
+                    const uint32_t v) {
+  memcpy(&data[pos], &v, sizeof(v));
+}
+
+static void test_round_trip(char const *bin_path) {
+  tile_map_source_rle<tile_ix, width> rle{tile_map_rle, tile_map_rle_rows,
+                                          height, tiles_count};
+  tile_map_source_file<tile_ix, width> file;
+  expect(file.open(bin_path, 0, tiles_count));
+  expect(file.height() == height);
+  for (int r = 0; r < height; r++) {
+    tile_ix row[width];
+    expect(rle.read_row(r, row) && !memcmp(row, tile_map[r], width));
+    expect(file.read_row(r, row) && !memcmp(row, tile_map[r], width));
+  }
+  tile_ix row[width];
+  expect(!file.read_row(-1, row));
+  expect(!file.read_row(height, row));
+
+  // scroll from bottom to top as the game does and back
+  tile_map_stream<tile_ix, width, rows> stream;
+  stream.set_source(&file);
+  expect(stream.height() == height);
+  for (int first = height - visible_rows; first >= 0; first--) {
+    stream.update(first, visible_rows);
+    for (int r = first; r < first + visible_rows; r++) {
+      expect(!memcmp(stream.row(r), tile_map[r], width));
+    }
+  }
+  for (int first = 0; first <= height - visible_rows; first += 3) {
+    stream.update(first, visible_rows);
+    for (int r = first; r < first + visible_rows; r++) {
+      expect(!memcmp(stream.row(r), tile_map[r], width));
+    }
+  }
+  file.close();
+}
+
+static void test_corrupt_file(char const *bin_path, char const *tmp_path) {
+  const std::vector<uint8_t> good = read_file(bin_path);
+  expect(good.size() > offset_pos(height + 1));
+  tile_map_source_file<tile_ix, width> file;
+  tile_ix row[width];
+  const int r = height / 2;
+
+  // wrong width
+  std::vector<uint8_t> data = good;
+  set_u32(data, 0, width + 1);
+  write_file(tmp_path, data);
+  expect(!file.open(tmp_path, 0, tiles_count));
+
+  // truncated header
+  write_file(tmp_path, std::vector<uint8_t>(good.begin(), good.begin() + 4));
+  expect(!file.open(tmp_path, 0, tiles_count));
+
+  // offset of next row before offset of row
+  data = good;
+  set_u32(data, offset_pos(r + 1), get_u32(data, offset_pos(r)) - 1);
+  write_file(tmp_path, data);
+  expect(file.open(tmp_path, 0, tiles_count));
+  expect(!file.read_row(r, row));
+  expect(file.read_row(r - 1, row) && !memcmp(row, tile_map[r - 1], width));
+  expect(!file.validate());
+
+  // row longer than 'width' pairs
+  data = good;
+  set_u32(data, offset_pos(r + 1),
+          get_u32(data, offset_pos(r)) + 2 * width + 2);
+  write_file(tmp_path, data);
+  expect(file.open(tmp_path, 0, tiles_count));
+  expect(!file.read_row(r, row));
+
+  // offset beyond end of file
+  data = good;
+  set_u32(data, offset_pos(height), uint32_t(data.size()));
+  set_u32(data, offset_pos(height - 1), uint32_t(data.size()) - 2);
+  write_file(tmp_path, data);
+  expect(file.open(tmp_path, 0, tiles_count));
+  expect(!file.read_row(height - 1, row));
+
+  // data of row ends before 'width' tiles
+  data = good;
+  set_u32(data, offset_pos(r + 1), get_u32(data, offset_pos(r)) + 1);
+  write_file(tmp_path, data);
+  expect(file.open(tmp_path, 0, tiles_count));
+  expect(!file.read_row(r, row));
+
+  // stream zeros rows that cannot be read
+  tile_map_stream<tile_ix, width, rows> stream;
+  stream.set_source(&file);
+  stream.update(r - 1, 2);
+  expect(!memcmp(stream.row(r - 1), tile_map[r - 1], width));
+  const tile_ix zeros[width]{};
+  expect(!memcmp(stream.row(r), zeros, width));
+
+  // tile indexes not less than tiles count
+  expect(file.open(bin_path, 0, tiles_count));
+  expect(file.validate());
+  int max_tile = 0;
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      max_tile = tile_map[i][j] > max_tile ? tile_map[i][j] : max_tile;
+    }
+  }
+  expect(file.open(bin_path, 0, max_tile + 1));
+  expect(file.validate());
+  expect(file.open(bin_path, 0, max_tile));
+  expect(!file.validate());
+  file.close();
+}
+
+// returns result of decoding 'len' values of 'src' into 'dst'
+static auto decode(tile_ix const *src, const int len, tile_ix *dst,
+                   const uint32_t tiles = tiles_count) -> bool {
+  return tile_map_decode_row<tile_ix, width>(src, src + len, dst, tiles);
+}
+
+static void test_corrupt_rows() {
+  tile_ix row[width];
+  // count of 0
+  const tile_ix zero_count[]{0, 1, 15, 1};
+  expect(!decode(zero_count, 4, row));
+  // counts exceeding 'width'
+  const tile_ix too_long[]{10, 1, 6, 2};
+  expect(!decode(too_long, 4, row));
+  // counts less than 'width'
+  const tile_ix too_short[]{10, 1, 4, 2};
+  expect(!decode(too_short, 4, row));
+  // odd number of values
+  const tile_ix odd[]{10, 1, 5};
+  expect(!decode(odd, 3, row));
+  const tile_ix good[]{10, 1, 5, 2};
+  expect(decode(good, 4, row));
+  expect(row[9] == 1 && row[10] == 2 && row[14] == 2);
+  // tile index not less than tiles count
+  expect(!decode(good, 4, row, 2));
+  expect(decode(good, 4, row, 3));
+}
+
+static void test_prefetch_margin() {
+  tile_map_source_rle<tile_ix, width> rle{tile_map_rle, tile_map_rle_rows,
+                                          height, tiles_count};
+  recording_source src{&rle};
+  tile_map_stream<tile_ix, width, rows> stream;
+  stream.set_source(&src);
+  stream.set_prefetch(true);
+
+  // only visible rows are loaded by 'update(...)'
+  const int first = 100;
+  stream.update(first, visible_rows);
+  expect(int(src.reads.size()) == visible_rows);
+  expect(src.reads.front() == first &&
+         src.reads.back() == first + visible_rows - 1);
+
+  // margin is loaded nearest first, alternating above and below
+  src.reads.clear();
+  while (stream.prefetch()) {
+  }
+  std::vector<int> expected;
+  for (int i = 1; i <= margin; i++) {
+    expected.push_back(first - i);
+    expected.push_back(first + visible_rows - 1 + i);
+  }
+  expect(src.reads == expected);
+  for (int r = first - margin; r < first + visible_rows + margin; r++) {
+    expect(!memcmp(stream.row(r), tile_map[r], width));
+  }
+
+  // scrolling one row up loads one visible row that was prefetched
+  src.reads.clear();
+  stream.update(first - 1, visible_rows);
+  expect(src.reads.empty());
+  expect(stream.prefetch());
+  expect(src.reads.size() == 1 && src.reads[0] == first - 1 - margin);
+
+  // margin is clipped at top and bottom of the map
+  src.reads.clear();
+  stream.update(0, visible_rows);
+  while (stream.prefetch()) {
+  }
+  for (int r : src.reads) {
+    expect(r >= 0 && r < visible_rows + margin);
+  }
+  src.reads.clear();
+  stream.update(height - visible_rows, visible_rows);
+  while (stream.prefetch()) {
+  }
+  for (int r : src.reads) {
+    expect(r >= height - visible_rows - margin && r < height);
+  }
+
+  // without prefetch the margin is loaded by 'update(...)'
+  stream.set_prefetch(false);
+  src.reads.clear();
+  stream.update(first, visible_rows);
+  expect(int(src.reads.size()) == visible_rows + 2 * margin);
+  expect(!stream.prefetch());
+}
+
+static void test_prefetch_thread(char const *bin_path) {
+  tile_map_source_file<tile_ix, width> file;
+  expect(file.open(bin_path, 0, tiles_count));
+  tile_map_stream<tile_ix, width, rows> stream;
+  stream.set_source(&file);
+  stream.set_prefetch(true);
+  stream.update(height - visible_rows, visible_rows);
+  std::atomic<bool> done{false};
+  std::thread prefetcher{[&] {
+    while (!done) {
+      if (!stream.prefetch()) {
+        std::this_thread::yield();
+      }
+    }
+  }};
+  for (int pass = 0; pass < 20; pass++) {
+    for (int first = height - visible_rows; first >= 0; first--) {
+      stream.update(first, visible_rows);
+      for (int r = first; r < first + visible_rows; r++) {
+        expect(!memcmp(stream.row(r), tile_map[r], width));
+      }
+    }
+  }
+  done = true;
+  prefetcher.join();
+  file.close();
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    printf("usage: %s <tile map .bin> <temporary file>\n", argv[0]);
+    return 2;
+  }
+  test_round_trip(argv[1]);
+  test_corrupt_file(argv[1], argv[2]);
+  test_corrupt_rows();
+  test_prefetch_margin();
+  test_prefetch_thread(argv[1]);
+  if (failures) {
+    printf("tile_map_stream_test: %d failures\n", failures);
+    return 1;
+  }
+  printf("tile_map_stream_test: ok\n");
+  return 0;
+}